@@ -0,0 +1,35 @@
+#pragma once
+#include "collision/aabb.hpp"
+#include <glm/glm.hpp>
+
+// Six clip planes (normals pointing inward) taken from a view-projection matrix,
+// so the same test serves the camera and every light's shadow projection
+struct Frustum {
+    glm::vec4 planes[6];
+
+    static Frustum FromMatrix(const glm::mat4& m) {
+        glm::vec4 row[4];
+        for (int i = 0; i < 4; i++) row[i] = glm::vec4(m[0][i], m[1][i], m[2][i], m[3][i]);
+
+        Frustum f;
+        f.planes[0] = row[3] + row[0];  // left
+        f.planes[1] = row[3] - row[0];  // right
+        f.planes[2] = row[3] + row[1];  // bottom
+        f.planes[3] = row[3] - row[1];  // top
+        f.planes[4] = row[3] + row[2];  // near
+        f.planes[5] = row[3] - row[2];  // far
+        return f;
+    }
+
+    // Conservative: boxes near a frustum corner may pass without being visible
+    bool Intersects(const AABB& box) const {
+        for (const glm::vec4& p : planes) {
+            // Corner furthest along the plane normal
+            glm::vec3 corner(p.x >= 0.0f ? box.max.x : box.min.x,
+                             p.y >= 0.0f ? box.max.y : box.min.y,
+                             p.z >= 0.0f ? box.max.z : box.min.z);
+            if (p.x * corner.x + p.y * corner.y + p.z * corner.z + p.w < 0.0f) return false;
+        }
+        return true;
+    }
+};
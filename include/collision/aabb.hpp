@@ -1,5 +1,6 @@
 #pragma once
 #include <glm/glm.hpp>
+#include <algorithm>
 #include "scenes/static_object.hpp"
 
 struct AABB {
@@ -17,8 +18,44 @@ struct AABB {
         return (min.x <= other.max.x && max.x >= other.min.x) &&
                (min.z <= other.max.z && max.z >= other.min.z);
     }
+
+    bool Contains(const AABB& other) const {
+        return min.x <= other.min.x && min.y <= other.min.y && min.z <= other.min.z &&
+               max.x >= other.max.x && max.y >= other.max.y && max.z >= other.max.z;
+    }
+
+    float SurfaceArea() const {
+        glm::vec3 d = max - min;
+        return 2.0f * (d.x * d.y + d.y * d.z + d.z * d.x);
+    }
 };
 
+inline AABB Combine(const AABB& a, const AABB& b) {
+    return { glm::min(a.min, b.min), glm::max(a.max, b.max) };
+}
+
+// Slab test of the segment from + t * delta for t in [0, maxT].
+// On a hit, tHit is the entry fraction (0 when the segment starts inside).
+inline bool SegmentIntersects(const AABB& box, const glm::vec3& from, const glm::vec3& delta,
+                              float maxT, float& tHit) {
+    float tEnter = 0.0f, tExit = maxT;
+    for (int axis = 0; axis < 3; axis++) {
+        if (delta[axis] == 0.0f) {
+            if (from[axis] < box.min[axis] || from[axis] > box.max[axis]) return false;
+            continue;
+        }
+        float inv = 1.0f / delta[axis];
+        float t0 = (box.min[axis] - from[axis]) * inv;
+        float t1 = (box.max[axis] - from[axis]) * inv;
+        if (t0 > t1) std::swap(t0, t1);
+        tEnter = std::max(tEnter, t0);
+        tExit = std::min(tExit, t1);
+        if (tEnter > tExit) return false;
+    }
+    tHit = tEnter;
+    return true;
+}
+
 // Build AABB from ObjectInstance (matches the render transform:
 //   translate(position) * scale(scale) * translate(0, 0.5, 0))
 // Result: x in [pos.x - scale.x/2, pos.x + scale.x/2]
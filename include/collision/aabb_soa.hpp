@@ -0,0 +1,63 @@
+#pragma once
+#include "collision/aabb.hpp"
+#include "utils/simd.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <vector>
+
+// Boxes per kernel block (one AVX register of floats)
+#define AABB_SOA_BLOCK 8
+#define AABB_SOA_ALIGNMENT 32
+
+template<typename T, size_t Alignment>
+struct AlignedAllocator {
+    using value_type = T;
+    template<typename U> struct rebind { using other = AlignedAllocator<U, Alignment>; };
+
+    AlignedAllocator() = default;
+    template<typename U> AlignedAllocator(const AlignedAllocator<U, Alignment>&) {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Alignment)));
+    }
+    void deallocate(T* p, size_t) { ::operator delete(p, std::align_val_t(Alignment)); }
+
+    template<typename U> bool operator==(const AlignedAllocator<U, Alignment>&) const { return true; }
+    template<typename U> bool operator!=(const AlignedAllocator<U, Alignment>&) const { return false; }
+};
+
+using AlignedFloats = std::vector<float, AlignedAllocator<float, AABB_SOA_ALIGNMENT>>;
+
+// Collider boxes stored as separate min/max x/y/z arrays, padded to whole blocks of
+// AABB_SOA_BLOCK with empty boxes, so one query box can be tested against a full block per
+// instruction. The kernel (scalar, SSE or AVX2) is picked from CPUID on first use.
+class AABBSoA {
+public:
+    int Add(const AABB& box);
+    void Set(int index, const AABB& box);
+    AABB Get(int index) const;
+    void Clear();
+
+    int Count() const { return count; }
+    int BlockCount() const { return (int)minX.size() / AABB_SOA_BLOCK; }
+
+    // One hit mask per block: bit j of masks[b] is set if box b * AABB_SOA_BLOCK + j overlaps
+    void OverlapMasks(const AABB& query, uint8_t* masks) const;
+    // Same as OverlapMasks with a specific kernel, for benchmarking
+    void OverlapMasks(const AABB& query, uint8_t* masks, SimdLevel level) const;
+
+    // True if any box other than ignoreIndex overlaps `query`
+    bool Overlaps(const AABB& query, int ignoreIndex = -1) const;
+    // Appends the index of every box overlapping `query`
+    void Query(const AABB& query, std::vector<int>& out) const;
+
+    // Kernel used by OverlapMasks/Overlaps/Query; defaults to DetectSimdLevel()
+    static SimdLevel level;
+
+private:
+    AlignedFloats minX, minY, minZ;
+    AlignedFloats maxX, maxY, maxZ;
+    int count = 0;
+    mutable std::vector<uint8_t> scratch;
+};
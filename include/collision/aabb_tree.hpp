@@ -0,0 +1,126 @@
+#pragma once
+#include "collision/aabb.hpp"
+#include "collision/sweep.hpp"
+#include <utility>
+#include <vector>
+
+// Margin added around every leaf, so small moves don't touch the tree
+#define AABB_TREE_FAT_MARGIN 0.5f
+// Fat boxes are also stretched along the last displacement, scaled by this
+#define AABB_TREE_DISPLACEMENT_MULTIPLIER 2.0f
+// Traversal stack depth; a balanced tree of a million leaves is ~40 deep
+#define AABB_TREE_STACK_SIZE 256
+
+// Dynamic bounding volume hierarchy for moving boxes.
+// Leaves hold a tight box plus a fat box that encloses it with some slack; MoveProxy only
+// re-inserts a leaf once its tight box leaves the fat one. Internal nodes are kept
+// balanced with tree rotations, so queries stay O(log n).
+class AABBTree {
+public:
+    AABBTree();
+
+    // Returns a proxy ID, stable until DestroyProxy. userData is any tag the caller wants back.
+    int CreateProxy(const AABB& box, int userData = 0);
+    void DestroyProxy(int proxy);
+    // Returns true if the leaf had to be re-inserted
+    bool MoveProxy(int proxy, const AABB& box, const glm::vec3& displacement = glm::vec3(0.0f));
+    void Clear();
+
+    const AABB& Box(int proxy) const { return nodes[proxy].box; }
+    const AABB& FatBox(int proxy) const { return nodes[proxy].fat; }
+    int UserData(int proxy) const { return nodes[proxy].userData; }
+    int ProxyCount() const { return proxyCount; }
+    int Height() const { return root == NullNode ? 0 : nodes[root].height; }
+
+    // Calls fn(proxy) for every leaf whose fat box overlaps `box`; return false from fn to stop
+    template<typename Fn> void Query(const AABB& box, Fn&& fn) const;
+    // Calls fn(proxy, maxT) for every leaf whose fat box the segment from + t * (to - from)
+    // crosses with t <= maxT. fn returns the new maxT: 0 stops, maxT leaves it unchanged.
+    template<typename Fn> void RayCast(const glm::vec3& from, const glm::vec3& to, Fn&& fn) const;
+
+    // True if any tight box (other than ignoreProxy) overlaps `box`
+    bool Overlaps(const AABB& box, int ignoreProxy = -1) const;
+    // Appends every proxy whose tight box overlaps `box`
+    void Query(const AABB& box, std::vector<int>& out) const;
+    // Closest tight box along the segment, or -1; tHit is the fraction along from..to
+    int RayCastClosest(const glm::vec3& from, const glm::vec3& to, float& tHit) const;
+    // Every pair of proxies whose tight boxes overlap, each once with first < second
+    void QueryPairs(std::vector<std::pair<int, int>>& out) const;
+    // Earliest hit of `box` moving by delta; hit.id is the proxy that was hit
+    bool Sweep(const AABB& box, const glm::vec3& delta, SweepHit& hit, int ignoreProxy = -1) const;
+
+private:
+    static constexpr int NullNode = -1;
+
+    struct Node {
+        AABB fat;       // leaves: tight box plus margin; internal nodes: union of children
+        AABB box;       // leaves only
+        int parent;     // next free node while on the free list
+        int child1;
+        int child2;
+        int height;     // 0 for leaves, -1 while free
+        int userData;
+
+        bool IsLeaf() const { return child1 == NullNode; }
+    };
+
+    std::vector<Node> nodes;
+    int root = NullNode;
+    int freeList = NullNode;
+    int proxyCount = 0;
+
+    int AllocateNode();
+    void FreeNode(int node);
+    void InsertLeaf(int leaf);
+    void RemoveLeaf(int leaf);
+    int Balance(int node);
+    void Refit(int node);
+};
+
+template<typename Fn>
+void AABBTree::Query(const AABB& box, Fn&& fn) const {
+    if (root == NullNode) return;
+
+    int stack[AABB_TREE_STACK_SIZE];
+    int count = 0;
+    stack[count++] = root;
+    while (count > 0) {
+        int index = stack[--count];
+        const Node& node = nodes[index];
+        if (!node.fat.Overlaps(box)) continue;
+
+        if (node.IsLeaf()) {
+            if (!fn(index)) return;
+        } else if (count + 2 <= AABB_TREE_STACK_SIZE) {
+            stack[count++] = node.child1;
+            stack[count++] = node.child2;
+        }
+    }
+}
+
+template<typename Fn>
+void AABBTree::RayCast(const glm::vec3& from, const glm::vec3& to, Fn&& fn) const {
+    if (root == NullNode) return;
+
+    glm::vec3 delta = to - from;
+    float maxT = 1.0f;
+
+    int stack[AABB_TREE_STACK_SIZE];
+    int count = 0;
+    stack[count++] = root;
+    while (count > 0) {
+        int index = stack[--count];
+        const Node& node = nodes[index];
+        float t;
+        if (!SegmentIntersects(node.fat, from, delta, maxT, t)) continue;
+
+        if (node.IsLeaf()) {
+            float value = fn(index, maxT);
+            if (value == 0.0f) return;
+            if (value > 0.0f) maxT = std::min(maxT, value);
+        } else if (count + 2 <= AABB_TREE_STACK_SIZE) {
+            stack[count++] = node.child1;
+            stack[count++] = node.child2;
+        }
+    }
+}
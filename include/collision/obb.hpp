@@ -0,0 +1,128 @@
+#pragma once
+#include "collision/aabb.hpp"
+#include "collision/sweep.hpp"
+#include "scenes/static_object.hpp"
+#include <cmath>
+
+// Added to |R| terms of the separating-axis test, so near-parallel edges whose cross
+// product is almost zero can't report a false separation
+#define OBB_SAT_EPSILON 1e-6f
+
+// Box with its own orthonormal axes; half[i] is the half-extent along axes[i]
+struct OBB {
+    glm::vec3 center;
+    glm::vec3 axes[3];
+    glm::vec3 half;
+
+    AABB Bounds() const {
+        glm::vec3 extent = glm::abs(axes[0]) * half.x + glm::abs(axes[1]) * half.y + glm::abs(axes[2]) * half.z;
+        return { center - extent, center + extent };
+    }
+
+    bool IsAxisAligned() const {
+        return axes[0] == glm::vec3(1, 0, 0) && axes[1] == glm::vec3(0, 1, 0) && axes[2] == glm::vec3(0, 0, 1);
+    }
+};
+
+inline OBB OBBFromAABB(const AABB& box) {
+    return { (box.min + box.max) * 0.5f,
+             { glm::vec3(1, 0, 0), glm::vec3(0, 1, 0), glm::vec3(0, 0, 1) },
+             (box.max - box.min) * 0.5f };
+}
+
+// The unit cube under the full render transform (ModelMatrixFromObject), rotation included.
+// Unrotated objects come out axis-aligned with the same bounds as AABBFromObject.
+inline OBB OBBFromObject(const ObjectInstance& obj) {
+    if (obj.rotation == glm::vec3(0.0f)) return OBBFromAABB(AABBFromObject(obj));
+
+    glm::mat4 m = ModelMatrixFromObject(obj);
+    OBB box;
+    box.center = glm::vec3(m[3]);
+    for (int i = 0; i < 3; i++) {
+        glm::vec3 column(m[i]);
+        float length = std::sqrt(glm::dot(column, column));
+        box.axes[i] = length > 0.0f ? column / length : glm::vec3(i == 0, i == 1, i == 2);
+        box.half[i] = length * 0.5f;
+    }
+    return box;
+}
+
+// Separating-axis test over the 15 candidate axes: 3 face normals of each box and the
+// 9 edge-edge cross products, all expressed in a's frame
+inline bool OBBOverlaps(const OBB& a, const OBB& b) {
+    float R[3][3], absR[3][3];
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            R[i][j] = glm::dot(a.axes[i], b.axes[j]);
+            absR[i][j] = std::abs(R[i][j]) + OBB_SAT_EPSILON;
+        }
+    }
+    glm::vec3 d = b.center - a.center;
+    float t[3] = { glm::dot(d, a.axes[0]), glm::dot(d, a.axes[1]), glm::dot(d, a.axes[2]) };
+
+    for (int i = 0; i < 3; i++) {
+        float rb = b.half[0] * absR[i][0] + b.half[1] * absR[i][1] + b.half[2] * absR[i][2];
+        if (std::abs(t[i]) > a.half[i] + rb) return false;
+    }
+    for (int j = 0; j < 3; j++) {
+        float ra = a.half[0] * absR[0][j] + a.half[1] * absR[1][j] + a.half[2] * absR[2][j];
+        if (std::abs(t[0] * R[0][j] + t[1] * R[1][j] + t[2] * R[2][j]) > ra + b.half[j]) return false;
+    }
+    for (int i = 0; i < 3; i++) {
+        int i1 = (i + 1) % 3, i2 = (i + 2) % 3;
+        for (int j = 0; j < 3; j++) {
+            int j1 = (j + 1) % 3, j2 = (j + 2) % 3;
+            float ra = a.half[i1] * absR[i2][j] + a.half[i2] * absR[i1][j];
+            float rb = b.half[j1] * absR[i][j2] + b.half[j2] * absR[i][j1];
+            if (std::abs(t[i2] * R[i1][j] - t[i1] * R[i2][j]) > ra + rb) return false;
+        }
+    }
+    return true;
+}
+
+// SweepAABB against an oriented target: the same slab intersection, run on every
+// separating axis instead of the three world axes. Overlaps at t = 0 are ignored.
+inline bool SweepOBB(const AABB& moving, const glm::vec3& delta, const OBB& target, SweepHit& hit) {
+    static const glm::vec3 world[3] = { glm::vec3(1, 0, 0), glm::vec3(0, 1, 0), glm::vec3(0, 0, 1) };
+    glm::vec3 movingHalf = (moving.max - moving.min) * 0.5f;
+    glm::vec3 d = target.center - (moving.min + moving.max) * 0.5f;
+
+    glm::vec3 axes[15];
+    int axisCount = 0;
+    for (int i = 0; i < 3; i++) axes[axisCount++] = world[i];
+    for (int i = 0; i < 3; i++) axes[axisCount++] = target.axes[i];
+    for (int i = 0; i < 3; i++) {
+        for (int j = 0; j < 3; j++) {
+            glm::vec3 axis = glm::cross(world[i], target.axes[j]);
+            if (glm::dot(axis, axis) > 1e-6f) axes[axisCount++] = axis;
+        }
+    }
+
+    float tEnter = -INFINITY, tExit = INFINITY;
+    int enterAxis = -1;
+    for (int k = 0; k < axisCount; k++) {
+        const glm::vec3& axis = axes[k];
+        float radius = glm::dot(glm::abs(axis), movingHalf) +
+                       target.half.x * std::abs(glm::dot(axis, target.axes[0])) +
+                       target.half.y * std::abs(glm::dot(axis, target.axes[1])) +
+                       target.half.z * std::abs(glm::dot(axis, target.axes[2]));
+        float gap = glm::dot(d, axis);
+        float speed = glm::dot(delta, axis);
+        if (speed == 0.0f) {
+            if (std::abs(gap) > radius) return false;
+            continue;
+        }
+        float t0 = (gap - radius) / speed;
+        float t1 = (gap + radius) / speed;
+        if (t0 > t1) std::swap(t0, t1);
+        if (t0 > tEnter) { tEnter = t0; enterAxis = k; }
+        tExit = std::min(tExit, t1);
+    }
+
+    if (enterAxis < 0 || tEnter > tExit || tEnter > 1.0f || tEnter < 0.0f) return false;
+
+    glm::vec3 normal = glm::normalize(axes[enterAxis]);
+    hit.t = tEnter;
+    hit.normal = glm::dot(delta, normal) > 0.0f ? -normal : normal;
+    return true;
+}
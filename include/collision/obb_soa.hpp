@@ -0,0 +1,35 @@
+#pragma once
+#include "collision/aabb_soa.hpp"
+#include "collision/obb.hpp"
+
+// Oriented boxes stored component-wise (centres, the nine axis components and half-extents
+// each in their own array), in the same AABB_SOA_BLOCK blocks as AABBSoA. A query first runs
+// the AABBSoA kernel over the boxes' bounds; only blocks with a bounds hit go through the
+// separating-axis kernel, which tests the query against all boxes of the block at once.
+class OBBSoA {
+public:
+    int Add(const OBB& box);
+    void Set(int index, const OBB& box);
+    OBB Get(int index) const;
+    void Clear();
+
+    int Count() const { return bounds.Count(); }
+    int BlockCount() const { return bounds.BlockCount(); }
+    const AABBSoA& Bounds() const { return bounds; }
+
+    // One hit mask per block, as AABBSoA::OverlapMasks
+    void OverlapMasks(const OBB& query, uint8_t* masks) const;
+    void OverlapMasks(const OBB& query, uint8_t* masks, SimdLevel level) const;
+
+    // True if any box other than ignoreIndex overlaps `query`
+    bool Overlaps(const OBB& query, int ignoreIndex = -1) const;
+    // Appends the index of every box overlapping `query`
+    void Query(const OBB& query, std::vector<int>& out) const;
+
+private:
+    AABBSoA bounds;
+    AlignedFloats center[3];
+    AlignedFloats axes[3][3];  // axes[i][c]: component c of axis i
+    AlignedFloats half[3];
+    mutable std::vector<uint8_t> scratch;
+};
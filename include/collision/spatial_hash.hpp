@@ -0,0 +1,33 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <vector>
+
+#define SPATIAL_HASH_CELL_SIZE 4.0f
+
+// Point buckets over the XZ plane, rebuilt from scratch every step: one counting pass,
+// a prefix sum and a scatter, so Build is O(n) with no per-cell allocations. Cells hash into
+// a power-of-two table about twice the point count; cells sharing a bucket only cost a few
+// extra distance tests.
+class SpatialHash {
+public:
+    explicit SpatialHash(float cellSize = SPATIAL_HASH_CELL_SIZE);
+
+    void Build(const glm::vec3* points, int count);
+
+    // Writes up to k indices of points within `radius` of pos (XZ distance), nearest first,
+    // and returns how many. radius must not exceed the cell size.
+    int Nearest(const glm::vec3& pos, float radius, int k, int ignore, int* out) const;
+
+    float CellSize() const { return cellSize; }
+
+private:
+    float cellSize;
+    float invCellSize;
+    unsigned int tableMask = 0;
+    std::vector<int> bucketStart;   // tableSize + 1 offsets into entries
+    std::vector<int> entries;       // point indices grouped by bucket
+    std::vector<glm::vec2> entryPos;  // XZ of entries[i], so queries stay in one array
+    std::vector<unsigned int> pointBucket;
+
+    unsigned int Bucket(int cx, int cz) const;
+};
@@ -0,0 +1,77 @@
+#pragma once
+#include "collision/aabb.hpp"
+#include <cmath>
+
+// Contacts handled per SweepAndSlide call (a corner takes two)
+#define SWEEP_MAX_ITERATIONS 3
+// Gap left between a moved box and what it hit, so the next sweep doesn't start touching
+#define SWEEP_SKIN 0.001f
+
+struct SweepHit {
+    float t = 1.0f;             // fraction of the movement before contact
+    glm::vec3 normal = glm::vec3(0.0f);  // contact normal, pointing back at the moving box
+    int id = -1;                // collider that was hit, as numbered by the structure swept
+};
+
+// Time of impact of `moving` travelling by delta against a static `target`.
+// Boxes that already overlap at t = 0 are ignored so a box can always move out of
+// an overlap; touching at t = 0 still blocks movement into the contact.
+inline bool SweepAABB(const AABB& moving, const glm::vec3& delta, const AABB& target, SweepHit& hit) {
+    float tEnter = -INFINITY, tExit = INFINITY;
+    int enterAxis = -1;
+    for (int axis = 0; axis < 3; axis++) {
+        if (delta[axis] == 0.0f) {
+            if (moving.max[axis] < target.min[axis] || moving.min[axis] > target.max[axis]) return false;
+            continue;
+        }
+        float inv = 1.0f / delta[axis];
+        float t0 = (target.min[axis] - moving.max[axis]) * inv;
+        float t1 = (target.max[axis] - moving.min[axis]) * inv;
+        if (t0 > t1) std::swap(t0, t1);
+        if (t0 > tEnter) { tEnter = t0; enterAxis = axis; }
+        tExit = std::min(tExit, t1);
+    }
+
+    if (enterAxis < 0 || tEnter > tExit || tEnter > 1.0f || tEnter < 0.0f) return false;
+
+    hit.t = tEnter;
+    hit.normal = glm::vec3(0.0f);
+    hit.normal[enterAxis] = delta[enterAxis] > 0.0f ? -1.0f : 1.0f;
+    return true;
+}
+
+// The box swept over the whole movement, for broadphase queries
+inline AABB SweptBounds(const AABB& box, const glm::vec3& delta) {
+    return { glm::min(box.min, box.min + delta), glm::max(box.max, box.max + delta) };
+}
+
+// Moves a box by delta, stopping at each contact and sliding the rest of the movement
+// along the contact plane. sweep(box, delta, hit) returns the earliest hit in a collider set.
+// Returns the displacement actually applied; `contact` receives the first hit, if any.
+template<typename SweepFn>
+glm::vec3 SweepAndSlide(const AABB& box, glm::vec3 delta, SweepFn&& sweep, SweepHit* contact = nullptr) {
+    glm::vec3 moved(0.0f);
+    bool first = true;
+
+    for (int i = 0; i < SWEEP_MAX_ITERATIONS; i++) {
+        float length = std::sqrt(glm::dot(delta, delta));
+        if (length < 1e-6f) break;
+
+        AABB current = { box.min + moved, box.max + moved };
+        SweepHit hit;
+        if (!sweep(current, delta, hit)) {
+            moved += delta;
+            break;
+        }
+
+        // Stop just short of the contact, then keep only the tangential remainder
+        float t = std::max(0.0f, hit.t - SWEEP_SKIN / length);
+        moved += delta * t;
+        delta *= 1.0f - t;
+        delta -= hit.normal * glm::dot(delta, hit.normal);
+
+        if (first && contact) *contact = hit;
+        first = false;
+    }
+    return moved;
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include "collision/aabb.hpp"
+#include "collision/obb.hpp"
+#include "collision/sweep.hpp"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Default cell edge in world units, a little larger than the typical building/car footprint
+#define UNIFORM_GRID_CELL_SIZE 4.0f
+
+// Broadphase over the XZ plane: each box is binned into every cell its footprint covers,
+// and a query only visits the cells the query box covers. Cells live in a hash map, so the
+// grid is unbounded and empty space costs nothing. Oriented boxes are binned by their bounds,
+// which then act as the pre-filter for an exact separating-axis test.
+class UniformGrid {
+public:
+    explicit UniformGrid(float cellSize = UNIFORM_GRID_CELL_SIZE);
+
+    // Returns a stable ID for Update/Remove; IDs of removed boxes are reused
+    int Insert(const AABB& box);
+    // Axis-aligned OBBs are stored as plain AABBs
+    int Insert(const OBB& box);
+    // Moves a box, touching the cell lists only when its covered cell range changes
+    void Update(int id, const AABB& box);
+    void Remove(int id);
+    void Clear();
+
+    // True if any stored box (other than ignoreId) overlaps `box`
+    bool Overlaps(const AABB& box, int ignoreId = -1) const;
+    // Appends the IDs of every stored box overlapping `box`, each once
+    void Query(const AABB& box, std::vector<int>& out) const;
+    // Earliest hit of `box` moving by delta; hit.id is the stored box that was hit
+    bool Sweep(const AABB& box, const glm::vec3& delta, SweepHit& hit, int ignoreId = -1) const;
+
+    // Bounds of the stored box (for oriented boxes, of the OBB)
+    const AABB& Box(int id) const { return items[id].box; }
+    int Count() const { return (int)items.size() - (int)freeIds.size(); }
+    int CellCount() const { return (int)cells.size(); }
+
+private:
+    struct CellRange {
+        int x0, z0, x1, z1;
+        bool operator==(const CellRange& o) const {
+            return x0 == o.x0 && z0 == o.z0 && x1 == o.x1 && z1 == o.z1;
+        }
+    };
+
+    struct Item {
+        AABB box;
+        CellRange range;
+        bool alive;
+        bool oriented;
+        mutable uint32_t queryStamp;
+    };
+
+    float invCellSize;
+    std::vector<Item> items;
+    std::vector<OBB> shapes;  // by ID, for oriented items
+    std::vector<int> freeIds;
+    std::unordered_map<uint64_t, std::vector<int>> cells;
+    mutable uint32_t queryStamp = 0;
+    mutable std::vector<int> sweepCandidates;
+
+    CellRange RangeOf(const AABB& box) const;
+    bool Hits(int id, const AABB& box) const;
+    static uint64_t CellKey(int x, int z);
+    void AddToCells(int id, const CellRange& range);
+    void RemoveFromCells(int id, const CellRange& range);
+};
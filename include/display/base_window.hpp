@@ -5,6 +5,7 @@
 #include "imgui.h"
 #include "imgui_impl_glfw.h"
 #include "imgui_impl_opengl3.h"
+#include "display/benchmark.hpp"
 #include <string>
 
 class BaseWindow {
@@ -12,6 +13,7 @@ class BaseWindow {
     int windowWidth, windowHeight;
     std::string windowTitle;
     GLFWwindow* windowHandle;
+    BenchmarkOptions benchmark;
 
     public:
     BaseWindow();
@@ -24,4 +26,10 @@ class BaseWindow {
     virtual void Update() = 0;
     virtual void Render() = 0;
     virtual void Unload() = 0;
-};
\ No newline at end of file
+
+    // Headless mode: called instead of the main loop when benchmark.enabled is set
+    virtual int RunBenchmark();
+
+    private:
+    GLFWwindow* CreateOffscreenWindow();
+};
@@ -0,0 +1,39 @@
+#pragma once
+#include <string>
+#include <vector>
+
+// Headless benchmark settings, filled from the command line (see main.cpp)
+struct BenchmarkOptions {
+    bool enabled = false;
+    bool collisionKernels = false;  // time the AABB and OBB overlap kernels instead of the scenes
+    bool noiseKernels = false;      // time the terrain noise kernels instead of the scenes
+    int frames = 300;
+    int warmupFrames = 30;
+    float deltaTime = 1.0f / 60.0f;
+    std::string outputPath = "benchmark.json";
+
+    // Record one scene's inputs while playing it, or replay a recording headless
+    std::string recordPath;
+    std::string replayPath;  // also sets enabled, so the run is headless
+    int scene = 0;           // scene index to record
+};
+
+struct SceneBenchmarkResult {
+    std::string name;
+    double loadMs = 0.0;
+    double unloadMs = 0.0;
+    std::vector<double> frameMs;
+    std::vector<double> updateMs;  // simulation and scene update only, no rendering
+    unsigned long long collisionQueries = 0;
+    unsigned long long drawCalls = 0;
+    unsigned long long triangles = 0;
+};
+
+bool ParseBenchmarkArgs(int argc, char** argv, BenchmarkOptions& options);
+// Scalar AoS loop vs the SoA kernels over growing box counts; no window or GL needed
+int RunCollisionBenchmark(const BenchmarkOptions& options);
+// Per-point virtual sampling vs the noise generator's batch kernels, in samples per second
+int RunNoiseBenchmark(const BenchmarkOptions& options);
+bool WriteBenchmarkReport(const std::string& path, const BenchmarkOptions& options,
+                          const std::string& renderer,
+                          const std::vector<SceneBenchmarkResult>& results);
@@ -9,7 +9,12 @@ public:
     void Update();
     void Render();
     void Unload();
+    int RunBenchmark();
 
 private:
     SceneManager sceneManager;
+
+    // One timed frame of the active scene; r may be null for warm-up frames
+    void HeadlessFrame(SceneBenchmarkResult* r);
+    int RunReplay();
 };
@@ -0,0 +1,44 @@
+#pragma once
+#include "ecs/world.hpp"
+#include "ecs/components.hpp"
+#include "collision/spatial_hash.hpp"
+#include <cstdint>
+#include <vector>
+
+// Neighbours each agent reacts to, nearest first
+#define AVOIDANCE_MAX_NEIGHBOURS 8
+// Search radius for neighbours; also the spatial hash cell size
+#define AVOIDANCE_NEIGHBOUR_DIST 4.0f
+// Collisions further ahead than this (seconds) are ignored
+#define AVOIDANCE_TIME_HORIZON 2.0f
+// Candidate velocities: this many headings at full and half speed, plus the preferred
+// velocity at full and half speed, and standing still
+#define AVOIDANCE_SAMPLE_DIRECTIONS 12
+// Penalty weight of 1 / time-to-collision against deviation from the preferred velocity
+#define AVOIDANCE_COLLISION_WEIGHT 2.0f
+
+// Sampled reciprocal velocity obstacles (RVO) in the XZ plane. Each step the positions and
+// last velocities of every Agent are copied into a spatial hash; each agent with a Velocity
+// then scores candidate velocities against its K nearest neighbours and writes the best one
+// to Agent::velocity. Two steering agents each take half the avoidance (the RVO apex); agents
+// without a Velocity are treated as not yielding.
+// Agents only read the snapshot, so Step runs on the thread pool and gives the same result
+// for any thread count.
+class AvoidanceSystem {
+public:
+    void Step(World& world);
+
+    // Neighbour queries issued by the last Step
+    int Queries() const { return queries; }
+
+private:
+    SpatialHash hash = SpatialHash(AVOIDANCE_NEIGHBOUR_DIST);
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec2> velocities;
+    std::vector<float> radii;
+    std::vector<uint8_t> steers;
+    std::vector<int> snapshotIndex;  // by Entity
+    int queries = 0;
+
+    void TakeSnapshot(World& world);
+};
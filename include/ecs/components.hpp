@@ -0,0 +1,45 @@
+#pragma once
+#include <glm/glm.hpp>
+
+// Pose after the last simulation step, and before it for render interpolation
+struct Transform {
+    glm::vec3 pos = glm::vec3(0.0f);
+    float yaw = 0.0f;  // degrees about +Y
+    glm::vec3 prevPos = glm::vec3(0.0f);
+    float prevYaw = 0.0f;
+};
+
+// Free movement in the XZ plane, units per second
+struct Velocity {
+    glm::vec3 linear = glm::vec3(0.0f);
+};
+
+// Drives around an axis-aligned ellipse centred on the origin
+struct TrackFollower {
+    float rx, rz;
+    float angle;       // current position on the ellipse (radians)
+    float speed;       // angular speed (radians/sec)
+};
+
+// Box around the entity's position, kept in a dynamic AABBTree
+struct Collider {
+    glm::vec3 half;
+    int tag = 0;       // proxy userData
+    int proxy = -1;    // created by SyncColliders
+};
+
+// Unit cube drawn with this scale and texture, raised by `lift` (in scaled units)
+struct RenderMesh {
+    glm::vec3 scale;
+    float lift;
+    unsigned int texture;
+};
+
+// Takes part in local avoidance. Entities that also have a Velocity steer around their
+// neighbours, treating Velocity as the preferred velocity; the rest (cars on rails, the
+// player) are only avoided.
+struct Agent {
+    float radius;
+    float maxSpeed;
+    glm::vec3 velocity = glm::vec3(0.0f);  // chosen by AvoidanceSystem, then observed after the move
+};
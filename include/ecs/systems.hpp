@@ -0,0 +1,76 @@
+#pragma once
+#include "ecs/world.hpp"
+#include "ecs/components.hpp"
+#include "collision/aabb.hpp"
+#include "collision/aabb_tree.hpp"
+#include "scenes/static_object.hpp"
+#include <cmath>
+
+// Start of a simulation step: the current pose becomes the interpolation start
+void StorePreviousTransforms(World& world);
+
+// Moves every TrackFollower along its ellipse, facing along the tangent
+void FollowTracks(World& world, float dt);
+
+// Creates tree proxies for new colliders and moves the rest to their entity's position.
+// Runs serially in storage order, so the tree comes out the same on every run.
+void SyncColliders(World& world, AABBTree& tree);
+
+// Agent::velocity becomes the distance actually moved this step over dt
+void ObserveVelocities(World& world, float dt);
+
+// Interpolated model matrices for everything with a RenderMesh
+void SubmitInstances(World& world, float alpha, InstanceBatch& batch);
+
+// Folds every simulated component, in storage order, into `hash`. RenderMesh is left out:
+// texture names depend on what the GL happened to hand out.
+uint64_t HashSimulationState(const World& world, uint64_t hash);
+
+// Single-entity steps, for systems that need extra checks around them
+
+inline void AdvanceOnTrack(Transform& t, TrackFollower& f, float dt) {
+    const float TWO_PI = 2.0f * 3.14159265f;
+    f.angle += f.speed * dt;
+    if (f.angle > TWO_PI) f.angle -= TWO_PI;
+    t.pos = glm::vec3(f.rx * std::cos(f.angle), t.pos.y, f.rz * std::sin(f.angle));
+    t.yaw = glm::degrees(std::atan2(-f.rx * std::sin(f.angle), f.rz * std::cos(f.angle)));
+}
+
+// Moves one axis at a time and reverses that axis of the velocity when blocked(pos) is true.
+// Returns the reversed axes: 1 for X, 2 for Z.
+template<typename Blocked>
+int MoveAndBounce(Transform& t, glm::vec3& velocity, float dt, Blocked&& blocked) {
+    glm::vec3 movement = velocity * dt;
+    glm::vec3 newPos = t.pos;
+    int bounced = 0;
+
+    newPos.x += movement.x;
+    if (blocked(newPos)) {
+        newPos.x = t.pos.x;
+        velocity.x = -velocity.x;
+        bounced |= 1;
+    }
+    newPos.z += movement.z;
+    if (blocked(newPos)) {
+        newPos.z = t.pos.z;
+        velocity.z = -velocity.z;
+        bounced |= 2;
+    }
+    t.pos = newPos;
+    return bounced;
+}
+
+// Moves an avoiding agent by its chosen velocity; a bounce also turns the preferred
+// velocity away from whatever was hit
+template<typename Blocked>
+int MoveAgentAndBounce(Transform& t, Agent& a, Velocity& v, float dt, Blocked&& blocked) {
+    int bounced = MoveAndBounce(t, a.velocity, dt, blocked);
+    if (bounced & 1) v.linear.x = std::copysign(v.linear.x, a.velocity.x);
+    if (bounced & 2) v.linear.z = std::copysign(v.linear.z, a.velocity.z);
+    return bounced;
+}
+
+// Radius of the circle around a box's XZ footprint, for Agent::radius
+inline float FootprintRadius(const glm::vec3& half) {
+    return glm::length(glm::vec2(half.x, half.z));
+}
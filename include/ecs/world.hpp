@@ -0,0 +1,174 @@
+#pragma once
+#include "utils/thread_pool.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+// Component types are numbered on first use; the mask of an archetype is one bit per type
+#define ECS_MAX_COMPONENTS 32
+#define ECS_NULL_ENTITY 0xFFFFFFFFu
+
+using Entity = uint32_t;
+using ComponentMask = uint32_t;
+
+// Archetype-based entity storage. Every entity with the same set of component types lives
+// in one archetype, which keeps each component in its own contiguous column, so systems
+// stream over plain arrays. Components must be trivially copyable: rows are moved with
+// memcpy when an entity is destroyed or changes archetype.
+// Create/Destroy/Add/Remove move rows around, so component references and column pointers
+// are only valid until the next structural change.
+class World {
+public:
+    template<typename... Cs> Entity Create(const Cs&... components);
+    // Swaps the last row of the archetype into the hole; entity IDs are reused
+    void Destroy(Entity e);
+    void Clear();
+
+    bool Alive(Entity e) const;
+    template<typename C> bool Has(Entity e) const;
+    template<typename C> C& Get(Entity e);
+    template<typename C> const C& Get(Entity e) const;
+    // Adding or removing a component moves the entity to the matching archetype
+    template<typename C> void Add(Entity e, const C& component);
+    template<typename C> void Remove(Entity e);
+
+    // fn(Cs&...) for every entity that has all of Cs, archetype by archetype in storage order
+    template<typename... Cs, typename Fn> void Each(Fn&& fn);
+    // fn(count, entities, Cs*...) once per matching archetype, with its whole columns
+    template<typename... Cs, typename Fn> void EachColumns(Fn&& fn);
+    template<typename... Cs, typename Fn> void EachColumns(Fn&& fn) const;
+    // Like EachColumns, but each archetype is split into chunks of `grain` rows run on the
+    // shared thread pool. fn may only write the rows it was given.
+    template<typename... Cs, typename Fn> void ParallelColumns(int grain, Fn&& fn);
+
+    int Count() const { return (int)records.size() - (int)freeEntities.size(); }
+    int ArchetypeCount() const { return (int)archetypes.size(); }
+
+    template<typename C> static int ComponentId();
+    template<typename... Cs> static ComponentMask MaskOf() { return ((1u << ComponentId<Cs>()) | ... | 0u); }
+
+private:
+    struct Column {
+        int componentId;
+        size_t stride;
+        std::vector<unsigned char> data;
+    };
+
+    struct Archetype {
+        ComponentMask mask;
+        int columnOf[ECS_MAX_COMPONENTS];  // index into columns, -1 if absent
+        std::vector<Column> columns;
+        std::vector<Entity> entities;
+
+        int Count() const { return (int)entities.size(); }
+        void* At(int componentId, int row) {
+            Column& c = columns[columnOf[componentId]];
+            return c.data.data() + c.stride * row;
+        }
+    };
+
+    struct Record {
+        int archetype;  // -1 while free
+        int row;
+    };
+
+    std::vector<Archetype> archetypes;
+    std::unordered_map<ComponentMask, int> archetypeByMask;
+    std::vector<Record> records;
+    std::vector<Entity> freeEntities;
+
+    static int RegisterComponent(size_t size);
+    static size_t ComponentSize(int componentId);
+
+    int FindOrCreateArchetype(ComponentMask mask);
+    Entity AllocateEntity();
+    // Appends an uninitialised row for e and returns its index
+    int PushRow(int archetype, Entity e);
+    void RemoveRow(int archetype, int row);
+    // Copies the components both archetypes share; new ones are left uninitialised
+    void MoveToArchetype(Entity e, ComponentMask mask);
+};
+
+template<typename C>
+int World::ComponentId() {
+    static_assert(std::is_trivially_copyable_v<C>, "ECS components must be trivially copyable");
+    static const int id = RegisterComponent(sizeof(C));
+    return id;
+}
+
+template<typename... Cs>
+Entity World::Create(const Cs&... components) {
+    Entity e = AllocateEntity();
+    int archetype = FindOrCreateArchetype(MaskOf<Cs...>());
+    int row = PushRow(archetype, e);
+    Archetype& a = archetypes[archetype];
+    (std::memcpy(a.At(ComponentId<Cs>(), row), &components, sizeof(Cs)), ...);
+    return e;
+}
+
+template<typename C>
+bool World::Has(Entity e) const {
+    if (!Alive(e)) return false;
+    return archetypes[records[e].archetype].mask & (1u << ComponentId<C>());
+}
+
+template<typename C>
+C& World::Get(Entity e) {
+    const Record& r = records[e];
+    return *static_cast<C*>(archetypes[r.archetype].At(ComponentId<C>(), r.row));
+}
+
+template<typename C>
+const C& World::Get(Entity e) const {
+    return const_cast<World*>(this)->Get<C>(e);
+}
+
+template<typename C>
+void World::Add(Entity e, const C& component) {
+    MoveToArchetype(e, archetypes[records[e].archetype].mask | (1u << ComponentId<C>()));
+    Get<C>(e) = component;
+}
+
+template<typename C>
+void World::Remove(Entity e) {
+    MoveToArchetype(e, archetypes[records[e].archetype].mask & ~(1u << ComponentId<C>()));
+}
+
+template<typename... Cs, typename Fn>
+void World::Each(Fn&& fn) {
+    EachColumns<Cs...>([&](int count, const Entity*, Cs*... columns) {
+        for (int i = 0; i < count; i++) fn(columns[i]...);
+    });
+}
+
+template<typename... Cs, typename Fn>
+void World::EachColumns(Fn&& fn) {
+    ComponentMask mask = MaskOf<Cs...>();
+    for (Archetype& a : archetypes) {
+        if ((a.mask & mask) != mask || a.entities.empty()) continue;
+        fn(a.Count(), a.entities.data(),
+           reinterpret_cast<Cs*>(a.columns[a.columnOf[ComponentId<Cs>()]].data.data())...);
+    }
+}
+
+template<typename... Cs, typename Fn>
+void World::EachColumns(Fn&& fn) const {
+    ComponentMask mask = MaskOf<Cs...>();
+    for (const Archetype& a : archetypes) {
+        if ((a.mask & mask) != mask || a.entities.empty()) continue;
+        fn(a.Count(), a.entities.data(),
+           reinterpret_cast<const Cs*>(a.columns[a.columnOf[ComponentId<Cs>()]].data.data())...);
+    }
+}
+
+template<typename... Cs, typename Fn>
+void World::ParallelColumns(int grain, Fn&& fn) {
+    EachColumns<Cs...>([&](int count, const Entity* entities, Cs*... columns) {
+        ThreadPool::Shared().ParallelFor(count, grain, [&](int begin, int end) {
+            fn(end - begin, entities + begin, (columns + begin)...);
+        });
+    });
+}
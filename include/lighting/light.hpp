@@ -30,3 +30,36 @@ struct SpotLight {
 #define MAX_SPOT_LIGHTS 4
 #define MAX_POINT_LIGHTS 8
 #define MAX_POINT_SHADOW_LIGHTS 3
+
+// std140 mirror of the "Lights" uniform block (resources/shaders/lighting_block.glsl).
+// Everything is vec4/mat4 sized so the C++ and GLSL layouts match without padding rules.
+struct SpotLightStd140 {
+    glm::vec4 position;       // xyz position, w range
+    glm::vec4 direction;      // xyz direction, w intensity
+    glm::vec4 color;          // rgb color, w cos(inner cone)
+    glm::vec4 cone;           // x cos(outer cone)
+    glm::mat4 lightSpaceMVP;
+};
+
+struct PointLightStd140 {
+    glm::vec4 position;       // xyz position, w intensity
+    glm::vec4 color;          // rgb color, w shadow far plane
+    glm::vec4 attenuation;    // x constant, y linear, z quadratic
+};
+
+struct LightBlockStd140 {
+    glm::vec4 sunDirection;   // xyz direction, w intensity
+    glm::vec4 sunColor;
+    glm::vec4 ambientColor;
+    glm::vec4 shadowParams;   // x point shadow near plane
+    int lightCounts[4];       // spot, point, point shadow casters
+    glm::mat4 sunLightSpaceMVP;
+    SpotLightStd140 spots[MAX_SPOT_LIGHTS];
+    PointLightStd140 points[MAX_POINT_LIGHTS];
+};
+
+static_assert(sizeof(SpotLightStd140) == 128, "SpotLightStd140 must match std140 layout");
+static_assert(sizeof(PointLightStd140) == 48, "PointLightStd140 must match std140 layout");
+static_assert(sizeof(LightBlockStd140) == 1040, "LightBlockStd140 must match std140 layout");
+
+#define LIGHT_BLOCK_BINDING 0
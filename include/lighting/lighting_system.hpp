@@ -21,16 +21,25 @@ public:
     void AddPointLight(const PointLight& light);
 
     // Render shadow maps — calls drawScene for each shadow-casting light
-    void RenderShadowMaps(std::function<void(unsigned int shaderID, const glm::mat4& lightMVP)> drawScene);
+    void RenderShadowMaps(std::function<void(Shader& shader, const glm::mat4& lightMVP)> drawScene);
 
-    // Upload all light data + bind shadow maps to the given lit shader
-    void ApplyToShader(unsigned int litShaderID, const glm::vec3& cameraPos);
+    // Upload changed light data to the shared uniform buffer and bind shadow maps for the given lit shader
+    void ApplyToShader(Shader& litShader, const glm::vec3& cameraPos);
 
     Shader& GetShadowShader() { return shadowShader; }
 
+    // Shadow map storage, assuming 32-bit depth
+    size_t MemoryBytes() const;
+
 private:
     Shader shadowShader;
 
+    // std140 "Lights" uniform buffer; uploadedBlock mirrors what the GPU currently holds
+    unsigned int lightUBO = 0;
+    LightBlockStd140 uploadedBlock;
+    bool uploadedValid = false;
+    std::vector<unsigned int> configuredShaders;  // Shader::linkId values with block/sampler bindings set
+
     // Sun shadow map
     unsigned int sunShadowFBO = 0;
     unsigned int sunShadowMap = 0;
@@ -54,6 +63,9 @@ private:
     static constexpr float POINT_SHADOW_NEAR = 0.1f;
 
     void CreateShadowFBO(unsigned int& fbo, unsigned int& depthMap);
+    void ConfigureShader(Shader& litShader);
+    void PackLightBlock(LightBlockStd140& block);
+    void UploadLightBlock();
     void CreateCubemapShadowFBO(unsigned int& fbo, unsigned int& cubemap);
     glm::mat4 CalcSunLightSpaceMatrix();
     glm::mat4 CalcSpotLightSpaceMatrix(const SpotLight& light);
@@ -0,0 +1,62 @@
+#pragma once
+#include "scenes/terrain_generator.hpp"
+#include "utils/simd.hpp"
+#include <cstdint>
+
+#define NOISE_MAX_OCTAVES 12
+// Octaves of the fBm that displaces the sample position in the domain-warp variant
+#define NOISE_WARP_OCTAVES 2
+
+enum class NoiseType { FBm, Ridged, DomainWarp };
+
+struct NoiseSettings {
+    NoiseType type = NoiseType::FBm;
+    uint32_t seed = 1337;
+    int octaves = 6;                // clamped to [1, NOISE_MAX_OCTAVES]
+    float frequency = 1.0f / 256.0f;  // of the first octave, in cycles per world unit
+    float amplitude = 24.0f;        // of the first octave, in world units
+    float lacunarity = 2.0f;        // frequency ratio between octaves
+    float gain = 0.5f;              // amplitude ratio between octaves
+    float warpStrength = 64.0f;     // DomainWarp: largest offset of the sample position, in world units
+    float baseHeight = 1.0f;        // added to every sample
+};
+
+// The settings expanded per octave. Every kernel reads the same precomputed values, so the
+// scalar, SSE and AVX2 paths return bit-identical heights (as long as the scalar path isn't
+// contracted into FMAs; CMakeLists.txt builds noise_generator.cpp with -ffp-contract=off).
+struct NoiseLayers {
+    NoiseType type = NoiseType::FBm;
+    uint32_t seed = 0;
+    int octaves = 0;
+    float frequency[NOISE_MAX_OCTAVES] = {};
+    float amplitude[NOISE_MAX_OCTAVES] = {};
+    float warpAmplitude[NOISE_WARP_OCTAVES] = {};
+    float warpStrength = 0.0f;
+    float baseHeight = 0.0f;
+};
+
+// Fractal 2D simplex noise: plain fBm, ridged (1 - |n|)^2 octaves, or fBm sampled at a
+// position displaced by two more fBm fields. Lattice gradients come from an integer hash of
+// the cell and the seed instead of a permutation table, so the SIMD kernels need no gathers
+// and the same seed always produces the same terrain. The batch calls run 4 (SSE) or 8 (AVX2)
+// samples per step, picked from CPUID like the collision kernels.
+class NoiseGenerator final : public TerrainGenerator {
+public:
+    explicit NoiseGenerator(const NoiseSettings& settings = NoiseSettings());
+
+    float GetHeight(float x, float z) const override;
+    void GetHeights(const float* xs, const float* zs, int count, float* out) const override;
+    void GetGrid(float x0, float z0, float spacing, int width, int height, float* out) const override;
+
+    // Same as GetHeights with a specific kernel, for benchmarking
+    void GetHeights(const float* xs, const float* zs, int count, float* out, SimdLevel kernelLevel) const;
+
+    const NoiseSettings& Settings() const { return settings; }
+
+    // Kernel used by GetHeights/GetGrid; defaults to DetectSimdLevel()
+    static SimdLevel level;
+
+private:
+    NoiseSettings settings;
+    NoiseLayers layers;
+};
@@ -11,12 +11,17 @@ public:
     void OnUpdate() override;
     void OnRender(const glm::mat4& view, const glm::mat4& projection) override;
     void OnUnload() override;
+    void OnPreload() override;
+    void OnCancelPreload() override;
 
 private:
     Road road;
     StaticObjectRenderer objectRenderer;
     std::vector<ObjectInstance> objects;
+    TransformCache objectTransforms;
+    InstanceBatch objectBatch;
     std::vector<unsigned int> loadedTextures;
 
+    void LoadTextures();
     void SetupObjects();
 };
@@ -11,14 +11,19 @@ public:
     void OnUpdate() override;
     void OnRender(const glm::mat4& view, const glm::mat4& projection) override;
     void OnUnload() override;
-    void OnRenderGeometry(unsigned int shaderID, const glm::mat4& lightMVP) override;
+    void OnPreload() override;
+    void OnCancelPreload() override;
+    void OnRenderGeometry(Shader& shader, const glm::mat4& lightMVP) override;
 
 private:
     Road road;
     StaticObjectRenderer objectRenderer;
     std::vector<ObjectInstance> objects;
+    TransformCache objectTransforms;
+    InstanceBatch objectBatch;
     std::vector<unsigned int> loadedTextures;
 
+    void LoadTextures();
     void SetupObjects();
     void SetupLights();
 };
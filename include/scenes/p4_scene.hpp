@@ -3,22 +3,29 @@
 #include "scenes/road.hpp"
 #include "scenes/static_object.hpp"
 #include "collision/aabb.hpp"
+#include "collision/uniform_grid.hpp"
 
 class P4Scene : public Scene3D {
 public:
     P4Scene();
 
     void OnLoad() override;
+    void OnFixedUpdate(float dt) override;
     void OnUpdate() override;
     void OnRender(const glm::mat4& view, const glm::mat4& projection) override;
     void OnUnload() override;
-    void OnRenderGeometry(unsigned int shaderID, const glm::mat4& lightMVP) override;
+    void OnPreload() override;
+    void OnCancelPreload() override;
+    void OnRenderGeometry(Shader& shader, const glm::mat4& lightMVP) override;
+    uint64_t OnHashState(uint64_t hash) const override;
 
 private:
     Road road;
     StaticObjectRenderer objectRenderer;
     std::vector<ObjectInstance> objects;
-    std::vector<AABB> colliders;
+    TransformCache objectTransforms;
+    InstanceBatch objectBatch;
+    UniformGrid colliders;  // static objects, binned once at load
     std::vector<unsigned int> loadedTextures;
 
     // Car state
@@ -27,6 +34,10 @@ private:
     float carSpeed = 0.0f;
     float collisionTimer = 0.0f;
 
+    // State at the start of the last simulation step, for render interpolation
+    glm::vec3 prevCarPos = carPos;
+    float prevCarYaw = 0.0f;
+
     static constexpr float CAR_MAX_SPEED = 15.0f;
     static constexpr float CAR_ACCEL = 20.0f;
     static constexpr float CAR_BRAKE = 30.0f;
@@ -38,9 +49,11 @@ private:
     glm::vec3 carScale = glm::vec3(1.5f, 1.0f, 2.5f);
     glm::vec3 carHalf = glm::vec3(1.0f, 1.5f, 1.0f);
 
+    void LoadTextures();
     void SetupObjects();
     void SetupLights();
     void UpdateCar(float dt);
-    void RenderCar(unsigned int shaderID);
+    void UpdateFollowCamera();
+    void RenderCar(int modelLoc);
     glm::mat4 GetCarModelMatrix() const;
 };
@@ -3,41 +3,41 @@
 #include "scenes/road.hpp"
 #include "scenes/static_object.hpp"
 #include "collision/aabb.hpp"
+#include "collision/uniform_grid.hpp"
+#include "collision/aabb_tree.hpp"
+#include "ecs/world.hpp"
+#include "ecs/avoidance.hpp"
 #include <vector>
 
-struct AICar {
-    float angle;       // current position on ellipse (radians)
-    float speed;       // angular speed (radians/sec)
-    glm::vec3 pos;
-    float yaw;
-};
-
-struct WanderCube {
-    glm::vec3 pos;
-    glm::vec3 dir;     // normalized XZ direction
-    float speed;
-};
-
 class P5Scene : public Scene3D {
 public:
     P5Scene();
 
     void OnLoad() override;
+    void OnFixedUpdate(float dt) override;
     void OnUpdate() override;
     void OnRender(const glm::mat4& view, const glm::mat4& projection) override;
     void OnUnload() override;
-    void OnRenderGeometry(unsigned int shaderID, const glm::mat4& lightMVP) override;
+    void OnPreload() override;
+    void OnCancelPreload() override;
+    void OnRenderGeometry(Shader& shader, const glm::mat4& lightMVP) override;
+    uint64_t OnHashState(uint64_t hash) const override;
 
 private:
     Road road;
     StaticObjectRenderer objectRenderer;
     std::vector<ObjectInstance> objects;
-    std::vector<AABB> staticColliders;
+    TransformCache objectTransforms;
+    InstanceBatch objectBatch;
+    InstanceBatch dynamicBatch;  // cars and wanderers, rebuilt every frame
+    UniformGrid staticColliders;   // binned once at load
+    AABBTree dynamicColliders;     // AI cars and wanderers, refit as they move
+    World world;                   // player car, AI cars and wanderers
+    AvoidanceSystem avoidance;     // wanderers steer around each other, the cars and the player
     std::vector<unsigned int> loadedTextures;
 
-    // Player car
-    glm::vec3 carPos = glm::vec3(37.5f, 0.0f, 0.0f);
-    float carYaw = 0.0f;
+    // Player car; its pose is the entity's Transform
+    Entity player = ECS_NULL_ENTITY;
     float carSpeed = 0.0f;
     float collisionTimer = 0.0f;
 
@@ -52,26 +52,24 @@ private:
     glm::vec3 carHalf = glm::vec3(1.0f, 1.5f, 1.0f);
 
     // AI cars
-    std::vector<AICar> aiCars;
+    int aiCarCount = 0;
     glm::vec3 aiCarScale = glm::vec3(1.5f, 1.0f, 2.5f);
     glm::vec3 aiCarHalf = glm::vec3(1.0f, 1.5f, 1.0f);
 
     // Wandering cubes
-    std::vector<WanderCube> wanderCubes;
+    int wanderCubeCount = 0;
     glm::vec3 wanderScale = glm::vec3(2.0f, 2.0f, 2.0f);
     glm::vec3 wanderHalf = glm::vec3(1.0f, 1.5f, 1.0f);
 
     static constexpr float ROAD_RX = 37.5f;
     static constexpr float ROAD_RZ = 27.5f;
 
+    void LoadTextures();
     void SetupObjects();
     void SetupLights();
+    void SpawnAgents();
     void UpdatePlayerCar(float dt);
-    void UpdateAICars(float dt);
     void UpdateWanderCubes(float dt);
-    void CollectDynamicColliders(std::vector<AABB>& out) const;
-    glm::mat4 GetPlayerCarModel() const;
-    glm::mat4 GetAICarModel(const AICar& ai) const;
-    glm::mat4 GetWanderCubeModel(const WanderCube& wc) const;
-    void RenderDynamic(unsigned int shaderID);
+    void UpdateFollowCamera();
+    void BuildDynamicBatch();
 };
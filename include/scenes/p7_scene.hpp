@@ -0,0 +1,98 @@
+#pragma once
+#include "scenes/scene3d.hpp"
+#include "scenes/static_object.hpp"
+#include "ecs/world.hpp"
+#include "ecs/avoidance.hpp"
+#include "collision/aabb.hpp"
+#include "collision/uniform_grid.hpp"
+#include "collision/aabb_tree.hpp"
+#include <cstdint>
+#include <vector>
+
+// Load targets for the stress scene; adjustable from its panel
+#define TRAFFIC_DEFAULT_CARS 10000
+#define TRAFFIC_DEFAULT_WANDERERS 50000
+#define TRAFFIC_DEFAULT_TRACKS 16
+// Simulation step times kept for the panel graph
+#define TRAFFIC_HISTORY 240
+
+// Load test: thousands of AI cars on concentric elliptical tracks plus wandering cubes,
+// all colliding through the same broadphase structures as P5 and drawn through the same
+// instanced path. Records simulation time and collision queries per step.
+class P7Scene : public Scene3D {
+public:
+    P7Scene();
+
+    void OnLoad() override;
+    void OnFixedUpdate(float dt) override;
+    void OnUpdate() override;
+    void OnRender(const glm::mat4& view, const glm::mat4& projection) override;
+    void OnUnload() override;
+    void OnPreload() override;
+    void OnCancelPreload() override;
+    void OnRenderGeometry(Shader& shader, const glm::mat4& lightMVP) override;
+    uint64_t OnHashState(uint64_t hash) const override;
+
+    uint64_t CollisionQueries() const override { return collisionQueries; }
+
+private:
+    struct Track {
+        float rx, rz;
+    };
+
+    // Proxy tags in dynamicColliders
+    static constexpr int TAG_CAR = 1;
+    static constexpr int TAG_WANDERER = 2;
+
+    StaticObjectRenderer objectRenderer;
+    std::vector<ObjectInstance> buildings;
+    TransformCache buildingTransforms;
+    InstanceBatch buildingBatch;
+    InstanceBatch dynamicBatch;
+    UniformGrid staticColliders;
+    AABBTree dynamicColliders;
+    std::vector<unsigned int> loadedTextures;
+
+    std::vector<Track> tracks;
+    // Cars and wanderers. Agents only see each other through dynamicColliders, which keeps
+    // the previous step's boxes until SyncColliders, so every agent reads the old state and
+    // writes only its own row; they can be updated in parallel with the same result.
+    World world;
+    AvoidanceSystem avoidance;
+    int spawnedCars = 0;
+    int spawnedWanderers = 0;
+    float worldRadius = 0.0f;
+
+    // Settings applied on the next (re)spawn
+    int carCount = TRAFFIC_DEFAULT_CARS;
+    int wandererCount = TRAFFIC_DEFAULT_WANDERERS;
+    int trackCount = TRAFFIC_DEFAULT_TRACKS;
+
+    // Stats
+    uint64_t collisionQueries = 0;
+    int stepQueries = 0;
+    int stepBlockedCars = 0;
+    int stepAvoidanceQueries = 0;
+    float stepMs[TRAFFIC_HISTORY] = {};
+    int stepIndex = 0;
+
+    glm::vec3 carScale = glm::vec3(1.5f, 1.0f, 2.5f);
+    glm::vec3 carHalf = glm::vec3(1.0f, 1.5f, 1.0f);
+    glm::vec3 wanderScale = glm::vec3(1.0f, 1.0f, 1.0f);
+    glm::vec3 wanderHalf = glm::vec3(0.5f, 1.0f, 0.5f);
+
+    static constexpr float CAR_SPACING = 5.0f;    // track length per car at full load
+    static constexpr float TRACK_GAP = 10.0f;     // radial distance between tracks
+    static constexpr float TRACK_ASPECT = 0.75f;  // rz / rx
+    static constexpr float LOOKAHEAD = 2.0f;      // how far ahead a car checks for traffic
+    static constexpr int AGENT_GRAIN = 512;       // agents per parallel chunk
+
+    void LoadTextures();
+    void Spawn();
+    void Despawn();
+    void UpdateCars(float dt);
+    void UpdateWanderers(float dt);
+    void BuildDynamicBatch();
+    void RenderStatsUI();
+    glm::vec3 TrackPoint(const Track& track, float angle) const;
+};
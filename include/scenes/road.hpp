@@ -26,5 +26,4 @@ private:
     float roadY = 1.02f;        // height above terrain (avoids z-fighting)
 
     void GenerateGeometry();
-    unsigned int LoadTexture(const std::string& path);
 };
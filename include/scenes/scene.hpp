@@ -1,10 +1,15 @@
 #pragma once
+#include <cstddef>
+#include <cstdint>
 #include <string>
 
 class Scene {
 public:
     std::string name;
     bool loaded = false;
+    bool preloaded = false;
+    // Seeds everything random in Load(), so a recording can be replayed on the same layout
+    uint32_t seed = 42;
 
     Scene(const std::string& name) : name(name) {}
     virtual ~Scene() = default;
@@ -13,4 +18,22 @@ public:
     virtual void Update() = 0;
     virtual void Render() = 0;
     virtual void Unload() = 0;
+
+    // A loaded scene may stay resident while another one is shown;
+    // these run when it becomes / stops being the active scene
+    virtual void Activate() {}
+    virtual void Deactivate() {}
+
+    // Start CPU-side loading work in the background ahead of Load()
+    virtual void Preload() {}
+    virtual void CancelPreload() {}
+
+    // Rough size of what the scene holds while loaded, for the residency budget
+    virtual size_t ResidentBytes() const { return 0; }
+
+    // Broadphase queries issued since load, for the benchmark report
+    virtual uint64_t CollisionQueries() const { return 0; }
+
+    // Hash of the simulated state, checked after every step when recording or replaying
+    virtual uint64_t StateHash() const { return 0; }
 };
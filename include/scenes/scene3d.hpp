@@ -20,8 +20,16 @@ struct Scene3DConfig {
 
     bool useTerrain = true;
     TerrainGenerator* terrainGenerator = nullptr;
+    int terrainSize = 200;  // world units per side, one height sample per unit
+    // Stream TERRAIN_TILE_SIZE tiles this many tiles around the camera instead (0 = fixed grid)
+    int terrainStreamRadius = 0;
 
     bool useLighting = false;
+
+    // Fixed-step simulation: OnFixedUpdate runs at simulationHz, at most
+    // maxSimulationSteps times per frame (excess time is dropped)
+    float simulationHz = 60.0f;
+    int maxSimulationSteps = 5;
 };
 
 class Scene3D : public Scene {
@@ -37,19 +45,40 @@ protected:
     Scene3DConfig config;
     bool cursorLocked = true;
 
+    // Fraction of a simulation step elapsed since the last OnFixedUpdate, for render interpolation
+    float interpolationAlpha = 1.0f;
+
     virtual void OnLoad() = 0;
+    // Simulation step at the fixed rate; runs before OnUpdate each frame
+    virtual void OnFixedUpdate(float /*dt*/) {}
+    // Once per rendered frame
     virtual void OnUpdate() = 0;
     virtual void OnRender(const glm::mat4& view, const glm::mat4& projection) = 0;
     virtual void OnUnload() = 0;
 
     // Override to draw scene geometry for shadow passes
-    virtual void OnRenderGeometry(unsigned int shaderID, const glm::mat4& lightMVP) {}
+    virtual void OnRenderGeometry(Shader& shader, const glm::mat4& lightMVP) {}
+
+    // Request assets early (e.g. textures) so OnLoad finds them decoding or done
+    virtual void OnPreload() {}
+    virtual void OnCancelPreload() {}
+
+    // Fold the scene's simulated state into `hash` (see HashBytes); the camera is already in
+    virtual uint64_t OnHashState(uint64_t hash) const { return hash; }
 
 private:
+    double simulationAccumulator = 0.0;
+
     void Load() override final;
     void Update() override final;
     void Render() override final;
     void Unload() override final;
+    void Activate() override final;
+    void Deactivate() override final;
+    void Preload() override final;
+    void CancelPreload() override final;
+    size_t ResidentBytes() const override;
+    uint64_t StateHash() const override;
 
     void RenderLit(const glm::mat4& view, const glm::mat4& projection);
     void RenderUnlit(const glm::mat4& view, const glm::mat4& projection);
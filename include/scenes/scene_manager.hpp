@@ -1,16 +1,35 @@
 #pragma once
 #include "scenes/scene.hpp"
+#include <cstddef>
 #include <vector>
 
+// Memory loaded-but-inactive scenes may hold before the least recently used is unloaded
+#define SCENE_RESIDENCY_BUDGET_MB 384
+
 class SceneManager {
 public:
     std::vector<Scene*> scenes;
     int activeIndex = -1;
 
+    size_t residencyBudgetBytes = (size_t)SCENE_RESIDENCY_BUDGET_MB * 1024 * 1024;
+    // Preload the next tab after each switch, and any tab the mouse hovers
+    bool preloadNeighbours = true;
+
     void RegisterScene(Scene* scene);
     void SwitchTo(int index);
+    void Preload(int index);
     void Update();
     void Render();
     void RenderTabs();
     void UnloadAll();
+
+    size_t ResidentBytes() const;
+
+private:
+    std::vector<int> recentlyUsed;  // loaded scenes, most recently shown last
+    int preloadIndex = -1;
+
+    void Touch(int index);
+    void UnloadScene(int index);
+    void EnforceBudget();
 };
@@ -7,6 +7,9 @@
 class Skybox {
 public:
     void Load();
+    // Request the cubemap ahead of Load(); decoding happens in the background
+    void Preload();
+    void CancelPreload();
     void Render(const glm::mat4& view, const glm::mat4& projection);
     void Unload();
 
@@ -16,6 +19,4 @@ private:
     unsigned int VBO = 0;
     unsigned int EBO = 0;
     unsigned int cubemapTexture = 0;
-
-    unsigned int LoadCubemap();
 };
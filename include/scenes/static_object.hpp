@@ -25,20 +25,80 @@ inline glm::mat4 ModelMatrixFromObject(const ObjectInstance& obj) {
     return m;
 }
 
+// 16-byte aligned model matrix; arrays of these can be uploaded or fed to SIMD code as-is
+struct alignas(16) AlignedMat4 {
+    glm::mat4 m;
+};
+static_assert(sizeof(AlignedMat4) == sizeof(glm::mat4), "AlignedMat4 must stay tightly packed");
+
+// World matrices for a list of static ObjectInstances, stored contiguously in the same order.
+// Computed once in Build() (call it again if the list changes); objects that move every step
+// live in the ECS instead.
+class TransformCache {
+public:
+    void Build(const std::vector<ObjectInstance>& objects);
+    void Clear();
+
+    int Count() const { return (int)matrices.size(); }
+    const glm::mat4& operator[](int index) const { return matrices[index].m; }
+    const glm::mat4* Data() const { return reinterpret_cast<const glm::mat4*>(matrices.data()); }
+
+private:
+    std::vector<AlignedMat4> matrices;
+};
+
+// Per-instance model matrix attribute; a mat4 takes locations 3-6
+#define INSTANCE_MODEL_LOCATION 3
+
+// Model matrices sorted by texture so each texture becomes one instanced draw.
+// Fill with Add(), then Upload(); the GL buffer lives until Unload().
+class InstanceBatch {
+public:
+    struct Group {
+        unsigned int textureID;
+        int first;
+        int count;
+    };
+
+    void Clear();
+    void Add(const glm::mat4& model, unsigned int textureID);
+    void Add(const std::vector<ObjectInstance>& objects, const TransformCache& transforms);
+    void Upload();
+    void Unload();
+
+    int Count() const { return (int)matrices.size(); }
+    const std::vector<Group>& Groups() const { return groups; }
+    unsigned int Buffer() const { return instanceVBO; }
+
+private:
+    struct Entry {
+        glm::mat4 model;
+        unsigned int textureID;
+    };
+
+    std::vector<Entry> entries;
+    std::vector<AlignedMat4> matrices;
+    std::vector<Group> groups;
+    unsigned int instanceVBO = 0;
+    int capacity = 0;
+};
+
 class StaticObjectRenderer {
 public:
     void Load();
-    void Render(const std::vector<ObjectInstance>& objects,
-                const glm::mat4& view, const glm::mat4& projection);
+    void Render(const InstanceBatch& batch, const glm::mat4& view, const glm::mat4& projection);
     void Unload();
     void BindAndDraw();
 
-    // Load a texture and return its GL ID — call this to prepare textures
-    unsigned int LoadTexture(const std::string& path);
+    // One glDrawElementsInstanced per texture group. The shader must already be in use and
+    // declare uInstanced; pass bindTextures = false for depth-only passes.
+    void DrawInstanced(Shader& activeShader, const InstanceBatch& batch, bool bindTextures = true);
 
 private:
     Shader shader;
     unsigned int cubeVAO = 0, cubeVBO = 0, cubeEBO = 0;
+    unsigned int instanceVAO = 0;  // same cube buffers, plus per-instance matrix attributes
 
     void CreateCubeMesh();
+    void SetupCubeAttributes();
 };
@@ -2,26 +2,144 @@
 #include "glad.h"
 #include "shaders/shader.hpp"
 #include "scenes/terrain_generator.hpp"
+#include "camera/frustum.hpp"
 #include <glm/glm.hpp>
+#include <atomic>
+#include <deque>
+#include <future>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 
+class ThreadPool;
+
+// Quads per side of the grid patch every quadtree node is drawn with (mirrored in terrain_block.glsl)
+#define TERRAIN_PATCH_RES 32
+// Distance at which the finest level hands over to the next; each coarser level doubles it
+#define TERRAIN_LOD_BASE_RANGE 64.0f
+// Fraction of a level's range after which its vertices start morphing toward the coarser level
+#define TERRAIN_MORPH_START 0.7f
+// Texture unit the heightmap is bound to, clear of the lit shader's albedo and shadow maps
+#define TERRAIN_HEIGHTMAP_UNIT 9
+
+// Streaming: world units per tile side (a multiple of TERRAIN_PATCH_RES)
+#define TERRAIN_TILE_SIZE 256
+// Threads generating tiles, kept apart from the shared simulation pool
+#define TERRAIN_STREAM_THREADS 2
+// Tile jobs queued at once; fewer means new nearby tiles don't wait behind stale ones
+#define TERRAIN_STREAM_MAX_JOBS 4
+// Finished tiles uploaded per frame, so a burst of arrivals never lands in a single frame
+#define TERRAIN_STREAM_UPLOADS_PER_FRAME 2
+
+// Samples at 1 unit spacing plus the height range of every quadtree node, built off the GL thread
+struct TerrainHeightfield {
+    glm::vec2 origin = glm::vec2(0.0f);  // world XZ of the min corner
+    int size = 0;                        // world units per side
+    int samples = 0;                     // per side: size + 1, plus one border sample each way for normals
+    std::vector<float> heights;          // row-major, one row per z
+    // Per level, finest first: levelSide[L]^2 nodes of TERRAIN_PATCH_RES << L units, (min, max) height
+    std::vector<int> levelSide;
+    std::vector<std::vector<glm::vec2>> ranges;
+};
+
+// CDLOD terrain: a min/max quadtree over a heightmap texture. Each pass selects nodes whose
+// level matches their distance from the camera, skipping nodes outside that pass's frustum,
+// and draws every node with the same grid patch displaced in the vertex shader. Vertices
+// morph into the next coarser grid as they approach a level's range, so levels meet without
+// seams or popping.
+//
+// The terrain is either one grid of gridSize units around the origin, or, when streaming, a
+// square ring of TERRAIN_TILE_SIZE tiles around the camera. Streamed tiles are sampled on
+// worker threads into a fixed set of slots whose textures and buffers are reused as the
+// ring moves, so memory stays the same however far the camera travels.
 class Terrain {
 public:
+    // Grid cells per side at 1 unit spacing; takes effect on the next Preload/Load
+    void SetGridSize(int size) { gridSize = size; }
+    // Tiles kept around the camera's tile in each direction; 0 keeps the single fixed grid.
+    // Takes effect on the next Load.
+    void SetStreaming(int radius) { streamRadius = radius; }
+
+    // Start the CPU side (heightfield sampling, texture decode) in the background; Load() picks it up
+    void Preload(TerrainGenerator* generator = nullptr);
+    void CancelPreload();
+
     void Load();
     void Load(TerrainGenerator* generator);
-    void Render(const glm::mat4& view, const glm::mat4& projection);
+    // Streaming only: upload finished tiles, evict the ones that left the ring and queue the
+    // missing ones, nearest first. Never waits on a worker unless `blocking`, which fills the
+    // whole ring before returning (for scene load).
+    void Stream(const glm::vec3& center, bool blocking = false);
+    // Unlit draw with the terrain's own shader
+    void Render(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& cameraPos);
     void Unload();
-    void DrawGeometry();
+
+    // Draws the nodes inside viewProjection's frustum with `activeShader`, which must be bound and
+    // include terrain_block.glsl. Levels are picked by distance to lodOrigin (the camera in
+    // every pass, so shadows match the visible geometry).
+    void DrawGeometry(Shader& activeShader, const glm::mat4& viewProjection, const glm::vec3& lodOrigin);
+
     unsigned int GetTexture() const { return texture; }
+    size_t MemoryBytes() const;
+    int LastNodeCount() const { return lastNodeCount; }
+    int ResidentTileCount() const;
 
 private:
+    struct Node {
+        int level, x, z;
+        int quadrants;  // child quadrants drawn at this level; 0xF for the whole node
+    };
+
+    enum class TileState { Empty, Generating, Resident };
+
+    // One heightmap texture and the quadtree over it: the whole terrain, or one streamed slot
+    struct Tile {
+        unsigned int heightmap = 0;
+        glm::vec2 origin = glm::vec2(0.0f);
+        int size = 0;
+        int samples = 0;
+        std::vector<int> levelSide;
+        std::vector<std::vector<glm::vec2>> ranges;
+
+        TileState state = TileState::Empty;
+        glm::ivec2 coord = glm::ivec2(0);  // streaming: tile index in TERRAIN_TILE_SIZE units
+        bool wanted = false;               // streaming: still inside the ring while generating
+    };
+
     Shader shader;
-    unsigned int VAO = 0, VBO = 0, EBO = 0;
+    unsigned int patchVAO = 0, patchVBO = 0, patchEBO = 0;
     unsigned int texture = 0;
-    int indexCount = 0;
+    int patchIndexCount = 0;
 
     int gridSize = 200;
+    std::vector<Tile> tiles;
+    std::vector<Node> selection;
+    int lastNodeCount = 0;
+
+    FlatGenerator flatGenerator = FlatGenerator(1.0f);
+    std::future<TerrainHeightfield> pendingHeightfield;
+    std::shared_ptr<std::atomic<bool>> preloadCancelled;  // shared with the preload job
+
+    // Streaming state. staging[i] is written only by the job generating tiles[i]; finished
+    // slot indices come back through streamFinished.
+    int streamRadius = 0;
+    const TerrainGenerator* streamGenerator = nullptr;
+    std::vector<TerrainHeightfield> staging;
+    std::vector<glm::ivec2> ringOffsets;  // nearest first
+    int streamJobs = 0;
+    std::mutex streamMutex;
+    std::deque<int> streamFinished;
+
+    static void BuildHeightfield(const TerrainGenerator* generator, glm::vec2 origin, int size,
+                                 ThreadPool* pool, TerrainHeightfield& field);
+    static void UploadHeightfield(Tile& tile, TerrainHeightfield& field);
+    void CreatePatch();
+    void LoadStreaming(const TerrainGenerator* generator);
+    void QueueTile(int index, glm::ivec2 coord);
 
-    unsigned int LoadTexture(const std::string& path);
-    void GenerateMesh(TerrainGenerator* generator);
+    AABB NodeBounds(const Tile& tile, int level, int x, int z) const;
+    float LodRange(int level) const { return TERRAIN_LOD_BASE_RANGE * (float)(1 << level); }
+    bool SelectNode(const Tile& tile, int level, int x, int z, const Frustum& frustum,
+                    const glm::vec3& lodOrigin, bool root);
 };
@@ -1,12 +1,50 @@
 #pragma once
+#include <cstddef>
 
+// Height source for Terrain. Sampled from worker threads, so every call must be read-only.
+// The batch calls are the hot path: one virtual call fills a whole span of points or a grid,
+// so implementations can inline, vectorise or run SIMD over it. Derive from PointGenerator
+// to get them from a plain per-point GetHeight.
 class TerrainGenerator {
 public:
     virtual ~TerrainGenerator() = default;
+
     virtual float GetHeight(float x, float z) const = 0;
+
+    // out[i] = height at (xs[i], zs[i]) for i in [0, count); e.g. a batch of physics queries
+    virtual void GetHeights(const float* xs, const float* zs, int count, float* out) const = 0;
+
+    // Row-major width x height grid (x fastest) starting at (x0, z0), `spacing` apart:
+    // out[row * width + col] = height at (x0 + col * spacing, z0 + row * spacing)
+    virtual void GetGrid(float x0, float z0, float spacing, int width, int height, float* out) const = 0;
+};
+
+// CRTP adapter: implements the batch calls as loops over Derived::GetHeight, called directly
+// rather than through the vtable so it inlines into the loop body.
+template <typename Derived>
+class PointGenerator : public TerrainGenerator {
+public:
+    void GetHeights(const float* xs, const float* zs, int count, float* out) const override {
+        const Derived& self = Self();
+        for (int i = 0; i < count; i++)
+            out[i] = self.Derived::GetHeight(xs[i], zs[i]);
+    }
+
+    void GetGrid(float x0, float z0, float spacing, int width, int height, float* out) const override {
+        const Derived& self = Self();
+        for (int row = 0; row < height; row++) {
+            float z = z0 + (float)row * spacing;
+            float* dst = out + (size_t)row * width;
+            for (int col = 0; col < width; col++)
+                dst[col] = self.Derived::GetHeight(x0 + (float)col * spacing, z);
+        }
+    }
+
+private:
+    const Derived& Self() const { return static_cast<const Derived&>(*this); }
 };
 
-class FlatGenerator : public TerrainGenerator {
+class FlatGenerator final : public PointGenerator<FlatGenerator> {
     float height;
 public:
     FlatGenerator(float h = 1.0f) : height(h) {}
@@ -2,9 +2,18 @@
 
 #include "glad.h"
 #include "glfw3.h"
+#include <glm/glm.hpp>
 #include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 #include <iostream>
 
+// Lets the uniform tables be queried with string_view/const char* without building a std::string
+struct UniformNameHash {
+    using is_transparent = void;
+    size_t operator()(std::string_view s) const { return std::hash<std::string_view>{}(s); }
+};
 
 class Shader {
     public:
@@ -14,12 +23,37 @@ class Shader {
 
     long fragmentModTimeOnLoad;
 
+    // Unique per successful link (program IDs can be recycled after a reload)
+    unsigned int linkId = 0;
+
     Shader();
     void Unload();
     void ReloadFromFile();
     static Shader LoadShader(std::string fileVertexShader, std::string fileFragmentShader);
 
+    // Locations come from the table built at link time; -1 if the uniform is not active
+    int GetUniformLocation(std::string_view name) const;
+    int GetUniformLocation(std::string_view arrayName, int index) const;
+
+    // Typed setters — the program must be bound with glUseProgram first
+    void SetInt(std::string_view name, int value) const;
+    void SetFloat(std::string_view name, float value) const;
+    void SetVec2(std::string_view name, const glm::vec2& value) const;
+    void SetVec3(std::string_view name, const glm::vec3& value) const;
+    void SetVec4(std::string_view name, const glm::vec4& value) const;
+    void SetMat4(std::string_view name, const glm::mat4& value) const;
+    void SetInt(std::string_view arrayName, int index, int value) const;
+    void SetFloat(std::string_view arrayName, int index, float value) const;
+    void SetVec3(std::string_view arrayName, int index, const glm::vec3& value) const;
+    void SetMat4(std::string_view arrayName, int index, const glm::mat4& value) const;
+
     private:
+    // name -> location, plus per-array element locations so "uFoo[i]" never has to be formatted
+    std::unordered_map<std::string, int, UniformNameHash, std::equal_to<>> uniformLocations;
+    std::unordered_map<std::string, std::vector<int>, UniformNameHash, std::equal_to<>> uniformArrays;
+
+    void ReflectUniforms();
+    static void ResolveIncludes(std::string& code, const std::string& file, int depth = 0);
     static bool CompileShader(unsigned int shaderId, char(&infoLog)[512]);
     static bool LinkProgram(unsigned int programID, char(&infoLog)[512]);
-};
\ No newline at end of file
+};
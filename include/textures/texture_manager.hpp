@@ -0,0 +1,94 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// GL-thread time spent per frame moving decoded images into textures
+#define TEXTURE_UPLOAD_BUDGET_MS 2.0
+// Large images are streamed in row bands of about this size, so one step stays short
+#define TEXTURE_UPLOAD_CHUNK_BYTES (512 * 1024)
+
+class ThreadPool;
+
+// Shared, refcounted GL textures keyed by path and by file content hash.
+// Acquire with Load2D/LoadCubemap and hand the ID back with Release. Textures whose
+// count drops to zero are kept until CollectUnused(), so a scene switch that reuses
+// an asset picks it up again without decoding.
+//
+// Decoding runs on a worker pool. The returned texture holds a small placeholder
+// until ProcessUploads() has streamed the real image in through a PBO; the GL ID
+// never changes, so callers can store it right away.
+class TextureManager {
+public:
+    // Build the mip chain on the workers (default) instead of glGenerateMipmap on the GL thread
+    static bool cpuMipmaps;
+
+    static unsigned int Load2D(const std::string& path);
+    // Faces in GL order: +X, -X, +Y, -Y, +Z, -Z
+    static unsigned int LoadCubemap(const std::vector<std::string>& faces);
+    static void Release(unsigned int textureID);
+
+    // Upload finished decodes, one row band at a time, until budgetMs is used up
+    static void ProcessUploads(double budgetMs);
+    // Block until every pending texture is decoded and uploaded
+    static void FinishPending();
+
+    // Delete every texture nobody holds any more
+    static void CollectUnused();
+    static void Shutdown();
+
+    static int TextureCount() { return (int)entries.size(); }
+    static int PendingCount();
+    static int DecodeCount() { return decodeCount; }
+
+private:
+    struct Entry {
+        unsigned int target;
+        int refCount;
+        uint64_t contentHash;
+        std::vector<std::string> keys;  // every path key that resolves to this texture
+        uint64_t job;                   // decode job that will fill this texture
+        bool ready;
+    };
+
+    struct ImageLevel {
+        int width = 0, height = 0, channels = 0;
+        std::vector<unsigned char> pixels;
+    };
+
+    // Worker output: faces[face][mip level]; a 2D texture has one face
+    struct DecodedTexture {
+        unsigned int textureID;
+        uint64_t job;
+        std::vector<std::vector<ImageLevel>> faces;
+        int nextFace = 0;
+        int nextLevel = 0;
+        int nextRow = 0;
+    };
+
+    static std::unordered_map<unsigned int, Entry> entries;
+    static std::unordered_map<std::string, unsigned int> byPath;
+    static std::unordered_map<uint64_t, unsigned int> byContent;
+    static std::atomic<int> decodeCount;
+    static uint64_t nextJob;
+
+    static std::unique_ptr<ThreadPool> pool;
+    static std::mutex completedMutex;
+    static std::deque<std::unique_ptr<DecodedTexture>> completed;  // filled by workers
+    static std::deque<std::unique_ptr<DecodedTexture>> uploads;    // GL thread only
+    static unsigned int uploadPBO;
+
+    static unsigned int Find(const std::string& key, uint64_t contentHash);
+    static unsigned int Insert(unsigned int textureID, unsigned int target,
+                               const std::string& key, uint64_t contentHash);
+    static void Destroy(unsigned int textureID);
+
+    static ThreadPool& Pool();
+    static void Decode(DecodedTexture& out, const std::vector<std::vector<unsigned char>>& files, bool mipmaps);
+    static void UploadBand(DecodedTexture& texture, unsigned int target);
+};
@@ -0,0 +1,11 @@
+#pragma once
+#include <cmath>
+
+// Interpolate between two angles in degrees along the shortest arc
+inline float LerpAngleDegrees(float from, float to, float t) {
+    float delta = std::fmod(to - from, 360.0f);
+    if (delta > 180.0f) delta -= 360.0f;
+    else if (delta < -180.0f) delta += 360.0f;
+    return from + delta * t;
+}
+
@@ -0,0 +1,79 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+
+// Number of frames kept for the rolling graphs and percentiles
+#define PROFILER_HISTORY 240
+// GPU timestamps are read back this many frames later so we never stall on the driver
+#define PROFILER_FRAME_LATENCY 3
+
+struct ProfilerSection {
+    std::string name;
+    int depth = 0;
+    uint64_t lastFrame = 0;
+    float cpuMs[PROFILER_HISTORY] = {};
+    float gpuMs[PROFILER_HISTORY] = {};
+};
+
+// Frame-phase profiler: CPU wall time and GPU time (GL timestamp queries) per named section.
+// Sections may nest; call Begin/EndSection in matching pairs or use PROFILE_SCOPE.
+class Profiler {
+public:
+    static bool enabled;
+    static bool gpuTiming;
+
+    static void BeginFrame();
+    static void EndFrame();
+    static void BeginSection(const char* name);
+    static void EndSection();
+
+    static void RenderUI();
+    static void Reset();
+    static void Shutdown();
+
+    // Frame time percentile over the last `count` frames (p in [0, 1]), in ms
+    static float FrameTimePercentile(float p, int count = PROFILER_HISTORY);
+    static int FrameCount();
+    static const std::vector<ProfilerSection>& Sections() { return sections; }
+
+private:
+    struct GpuRecord {
+        int section;
+        unsigned int queryBegin;
+        unsigned int queryEnd;
+    };
+
+    struct FrameQueries {
+        uint64_t frame = 0;
+        std::vector<unsigned int> pool;
+        int used = 0;
+        std::vector<GpuRecord> records;
+    };
+
+    struct OpenSection {
+        int section;
+        double cpuStart;
+        int record;
+    };
+
+    static std::vector<ProfilerSection> sections;
+    static std::vector<OpenSection> stack;
+    static FrameQueries frames[PROFILER_FRAME_LATENCY];
+    static float frameMs[PROFILER_HISTORY];
+    static uint64_t frameIndex;
+    static double frameStart;
+
+    static int FindOrAddSection(const char* name, int depth);
+    static unsigned int AcquireQuery(FrameQueries& fq);
+    static void CollectGpuResults(FrameQueries& fq);
+};
+
+struct ProfileScope {
+    ProfileScope(const char* name) { Profiler::BeginSection(name); }
+    ~ProfileScope() { Profiler::EndSection(); }
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
@@ -0,0 +1,14 @@
+#pragma once
+
+// Counts draw calls by wrapping glad's draw entry points.
+// Call Install() once after GLAD has loaded; counting is then always on.
+struct RenderStats {
+    static unsigned long long drawCalls;
+    static unsigned long long triangles;
+
+    static void Install();
+    static void Reset() {
+        drawCalls = 0;
+        triangles = 0;
+    }
+};
@@ -0,0 +1,79 @@
+#pragma once
+#include "glfw3.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#define REPLAY_MAGIC 0x59504c52u  // "RLPY"
+#define REPLAY_VERSION 1
+// Set in ReplayFrame::keys when the free camera took input that frame
+#define REPLAY_CAMERA_ACTIVE (1u << 31)
+
+// 64-bit FNV-1a, chained through `hash`
+inline uint64_t HashBytes(const void* data, size_t size, uint64_t hash = 0xcbf29ce484222325ull) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ull;
+    }
+    return hash;
+}
+
+// Everything the simulation reads from the outside world in one rendered frame
+struct ReplayFrame {
+    float deltaTime;
+    uint32_t keys;      // one bit per entry of the tracked key table
+    float mouseDeltaX;
+    float mouseDeltaY;
+};
+
+struct Recording {
+    int scene = 0;
+    uint32_t seed = 0;
+    std::vector<ReplayFrame> frames;
+    std::vector<uint64_t> stepHashes;  // Scene::StateHash() after every simulation step
+
+    bool Save(const std::string& path) const;
+    bool Load(const std::string& path);
+};
+
+// Records the inputs of a scene run, or plays them back in place of the keyboard, mouse
+// and clock while checking the state hash after every simulation step.
+// Simulation code reads keys through KeyDown() instead of glfwGetKey().
+class Replay {
+public:
+    enum class Mode { Off, Recording, Playing };
+
+    static void StartRecording(int scene, uint32_t seed);
+    // Writes the recording and returns to live input
+    static bool StopRecording(const std::string& path);
+    static void StartPlayback(const Recording& recording);
+    static void StopPlayback();
+
+    static Mode GetMode() { return mode; }
+    static bool Active() { return mode != Mode::Off; }
+    static bool PlaybackFinished() { return mode == Mode::Playing && frameIndex >= (int)recording.frames.size(); }
+
+    // Start of a scene frame: records, or replaces, Time::deltaTime and the key state.
+    // cameraActive is whether the free camera takes input this frame.
+    static void BeginFrame(GLFWwindow* window, bool& cameraActive);
+    static bool KeyDown(GLFWwindow* window, int key);
+    static void FilterMouseDelta(float& dx, float& dy);
+    // After every simulation step
+    static void Step(uint64_t stateHash);
+
+    // Playback results
+    static int StepsChecked() { return stepIndex; }
+    static int Mismatches() { return mismatches; }
+    static int FirstMismatch() { return firstMismatch; }
+
+private:
+    static Mode mode;
+    static Recording recording;
+    static ReplayFrame current;
+    static int frameIndex;
+    static int stepIndex;
+    static int mismatches;
+    static int firstMismatch;
+};
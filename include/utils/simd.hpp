@@ -0,0 +1,19 @@
+#pragma once
+
+// Kernels for each SimdLevel are compiled side by side, with per-function target attributes
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define SIMD_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define SIMD_TARGET(isa)
+#else
+#define SIMD_TARGET(isa) __attribute__((target(isa)))
+#endif
+#endif
+
+enum class SimdLevel { Scalar, SSE, AVX2 };
+
+// Best kernel this CPU and OS support
+SimdLevel DetectSimdLevel();
+const char* SimdLevelName(SimdLevel level);
@@ -0,0 +1,44 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads draining a FIFO job queue.
+// Jobs must not touch GL; post results back to the GL thread instead.
+class ThreadPool {
+public:
+    explicit ThreadPool(int threadCount = DefaultThreadCount());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void Submit(std::function<void()> job);
+    // Block until the queue is empty and no job is running
+    void Wait();
+
+    // Calls fn(begin, end) over [0, count) in chunks of `grain` items, on the workers and
+    // the calling thread, and returns once every chunk is done. Chunk boundaries depend
+    // only on count and grain, never on the thread count.
+    void ParallelFor(int count, int grain, const std::function<void(int, int)>& fn);
+
+    int ThreadCount() const { return (int)workers.size(); }
+    // One thread left for the GL/main thread, at least one worker
+    static int DefaultThreadCount();
+    // Pool for simulation work, created on first use
+    static ThreadPool& Shared();
+
+private:
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> jobs;
+    std::mutex mutex;
+    std::condition_variable jobAvailable;
+    std::condition_variable idle;
+    int running = 0;
+    bool stopping = false;
+
+    void WorkerLoop();
+};
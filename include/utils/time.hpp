@@ -2,19 +2,30 @@
 #include "glfw3.h"
 
 struct Time {
+    // Frame delta in seconds. Computed from double-precision timestamps so it stays
+    // accurate however long the app has been running.
     static float deltaTime;
-    static float time;
-    static float lastFrameTime;
+    static double time;
+    static double lastFrameTime;
+
+    // When > 0, Update() advances by exactly this step instead of reading the clock
+    static float fixedDeltaTime;
 
     static void Update() {
-        float currentTime = (float)glfwGetTime();
-        deltaTime = currentTime - lastFrameTime;
+        if (fixedDeltaTime > 0.0f) {
+            deltaTime = fixedDeltaTime;
+            time += fixedDeltaTime;
+            lastFrameTime = time;
+            return;
+        }
+        double currentTime = glfwGetTime();
+        deltaTime = (float)(currentTime - lastFrameTime);
         lastFrameTime = currentTime;
         time = currentTime;
     }
 
     static void Reset() {
-        lastFrameTime = (float)glfwGetTime();
+        lastFrameTime = (fixedDeltaTime > 0.0f) ? 0.0 : glfwGetTime();
         deltaTime = 0.0f;
         time = lastFrameTime;
     }
@@ -0,0 +1,30 @@
+// Shared light data — mirrors LightBlockStd140 in include/lighting/light.hpp.
+// Filled by LightingSystem into one uniform buffer bound to every program that includes this.
+#define MAX_SPOT_LIGHTS 4
+#define MAX_POINT_LIGHTS 8
+#define MAX_POINT_SHADOW_LIGHTS 3
+
+struct SpotLightData {
+    vec4 position;      // xyz position, w range
+    vec4 direction;     // xyz direction, w intensity
+    vec4 color;         // rgb color, w cos(inner cone)
+    vec4 cone;          // x cos(outer cone)
+    mat4 lightSpaceMVP;
+};
+
+struct PointLightData {
+    vec4 position;      // xyz position, w intensity
+    vec4 color;         // rgb color, w shadow far plane (shadow casters only)
+    vec4 attenuation;   // x constant, y linear, z quadratic
+};
+
+layout (std140) uniform Lights {
+    vec4 uSunDirection;     // xyz direction, w intensity
+    vec4 uSunColor;         // rgb
+    vec4 uAmbientColor;     // rgb
+    vec4 uShadowParams;     // x point shadow near plane
+    ivec4 uLightCounts;     // x spot lights, y point lights, z point shadow casters
+    mat4 uSunLightSpaceMVP;
+    SpotLightData uSpots[MAX_SPOT_LIGHTS];
+    PointLightData uPoints[MAX_POINT_LIGHTS];
+};
@@ -6,7 +6,8 @@ in vec3 fragNormal;
 in vec2 texCoord;
 in vec4 fragPosLightSpace;
 
-#define MAX_SPOT_LIGHTS 4
+#include "lighting_block.glsl"
+
 in vec4 fragPosSpotSpace[MAX_SPOT_LIGHTS];
 
 // Material
@@ -15,42 +16,10 @@ uniform sampler2D uTexture;
 // Camera
 uniform vec3 uViewPos;
 
-// Directional light (sun)
-uniform vec3 uSunDirection;
-uniform vec3 uSunColor;
-uniform float uSunIntensity;
+// Shadow maps (light parameters live in the Lights block)
 uniform sampler2D uSunShadowMap;
-
-// Spot lights
-uniform int uNumSpotLights;
-uniform vec3 uSpotPos[MAX_SPOT_LIGHTS];
-uniform vec3 uSpotDir[MAX_SPOT_LIGHTS];
-uniform vec3 uSpotColor[MAX_SPOT_LIGHTS];
-uniform float uSpotIntensity[MAX_SPOT_LIGHTS];
-uniform float uSpotCutOff[MAX_SPOT_LIGHTS];
-uniform float uSpotOuterCutOff[MAX_SPOT_LIGHTS];
-uniform float uSpotRange[MAX_SPOT_LIGHTS];
 uniform sampler2D uSpotShadowMap[MAX_SPOT_LIGHTS];
-
-// Point lights
-#define MAX_POINT_LIGHTS 8
-uniform int uNumPointLights;
-uniform vec3 uPointPos[MAX_POINT_LIGHTS];
-uniform vec3 uPointColor[MAX_POINT_LIGHTS];
-uniform float uPointIntensity[MAX_POINT_LIGHTS];
-uniform float uPointConstant[MAX_POINT_LIGHTS];
-uniform float uPointLinear[MAX_POINT_LIGHTS];
-uniform float uPointQuadratic[MAX_POINT_LIGHTS];
-
-// Point light cubemap shadows
-#define MAX_POINT_SHADOW_LIGHTS 3
 uniform samplerCube uPointShadowMap[MAX_POINT_SHADOW_LIGHTS];
-uniform float uPointFarPlane[MAX_POINT_SHADOW_LIGHTS];
-uniform float uPointShadowNear;
-uniform int uNumPointShadowLights;
-
-// Ambient
-uniform vec3 uAmbientColor;
 
 float CalcShadow(vec4 fragPosLight, sampler2D shadowMap, vec3 lightDir, vec3 normal)
 {
@@ -79,6 +48,15 @@ float CalcShadow(vec4 fragPosLight, sampler2D shadowMap, vec3 lightDir, vec3 nor
     return shadow;
 }
 
+// Sampler arrays may only be indexed with constants in GLSL 3.30, so pick the map explicitly
+float CalcSpotShadow(int lightIndex, vec4 fragPosLight, vec3 lightDir, vec3 normal)
+{
+    if (lightIndex == 0) return CalcShadow(fragPosLight, uSpotShadowMap[0], lightDir, normal);
+    if (lightIndex == 1) return CalcShadow(fragPosLight, uSpotShadowMap[1], lightDir, normal);
+    if (lightIndex == 2) return CalcShadow(fragPosLight, uSpotShadowMap[2], lightDir, normal);
+    return CalcShadow(fragPosLight, uSpotShadowMap[3], lightDir, normal);
+}
+
 // PCF offset directions for cubemap shadow sampling (20 samples)
 const vec3 sampleOffsetDirections[20] = vec3[](
     vec3( 1,  1,  1), vec3( 1, -1,  1), vec3(-1, -1,  1), vec3(-1,  1,  1),
@@ -105,7 +83,7 @@ float CalcPointShadow(int lightIndex, vec3 fragToLight, float currentDist, float
             closestDepth = texture(uPointShadowMap[2], fragToLight + sampleOffsetDirections[s] * diskRadius).r;
 
         // Linearize depth from [0,1] to world-space distance
-        float near = uPointShadowNear;
+        float near = uShadowParams.x;
         float far = farPlane;
         float linearDepth = (2.0 * near * far) / (far + near - (2.0 * closestDepth - 1.0) * (far - near));
 
@@ -124,33 +102,35 @@ void main()
     vec3 texColor = texture(uTexture, texCoord).rgb;
 
     // Ambient
-    vec3 ambient = uAmbientColor * texColor;
+    vec3 ambient = uAmbientColor.rgb * texColor;
 
     // --- Directional light (sun) ---
-    vec3 sunDir = normalize(-uSunDirection);
+    vec3 sunDir = normalize(-uSunDirection.xyz);
     float sunDiff = max(dot(normal, sunDir), 0.0);
     vec3 sunHalf = normalize(sunDir + viewDir);
     float sunSpec = pow(max(dot(normal, sunHalf), 0.0), 32.0);
 
-    float sunShadow = CalcShadow(fragPosLightSpace, uSunShadowMap, uSunDirection, normal);
+    float sunShadow = CalcShadow(fragPosLightSpace, uSunShadowMap, uSunDirection.xyz, normal);
 
     vec3 sunResult = (1.0 - sunShadow) * (sunDiff * texColor + sunSpec * vec3(0.3))
-                     * uSunColor * uSunIntensity;
+                     * uSunColor.rgb * uSunDirection.w;
 
     // --- Spot lights ---
     vec3 spotResult = vec3(0.0);
-    for (int i = 0; i < uNumSpotLights; i++) {
-        vec3 lightVec = uSpotPos[i] - fragPos;
+    for (int i = 0; i < uLightCounts.x; i++) {
+        vec3 lightVec = uSpots[i].position.xyz - fragPos;
         float dist = length(lightVec);
         vec3 lightDir = normalize(lightVec);
 
         // Cone attenuation
-        float theta = dot(lightDir, normalize(-uSpotDir[i]));
-        float epsilon = uSpotCutOff[i] - uSpotOuterCutOff[i];
-        float spotAtten = clamp((theta - uSpotOuterCutOff[i]) / epsilon, 0.0, 1.0);
+        float cutOff = uSpots[i].color.w;
+        float outerCutOff = uSpots[i].cone.x;
+        float theta = dot(lightDir, normalize(-uSpots[i].direction.xyz));
+        float epsilon = cutOff - outerCutOff;
+        float spotAtten = clamp((theta - outerCutOff) / epsilon, 0.0, 1.0);
 
         // Distance attenuation
-        float distAtten = clamp(1.0 - dist / uSpotRange[i], 0.0, 1.0);
+        float distAtten = clamp(1.0 - dist / uSpots[i].position.w, 0.0, 1.0);
         distAtten *= distAtten;
 
         // Diffuse + specular
@@ -158,23 +138,23 @@ void main()
         vec3 halfDir = normalize(lightDir + viewDir);
         float spec = pow(max(dot(normal, halfDir), 0.0), 32.0);
 
-        float spotShadow = CalcShadow(fragPosSpotSpace[i], uSpotShadowMap[i], -lightDir, normal);
+        float spotShadow = CalcSpotShadow(i, fragPosSpotSpace[i], -lightDir, normal);
 
         vec3 contribution = (1.0 - spotShadow) * (diff * texColor + spec * vec3(0.3))
-                           * uSpotColor[i] * uSpotIntensity[i] * spotAtten * distAtten;
+                           * uSpots[i].color.rgb * uSpots[i].direction.w * spotAtten * distAtten;
         spotResult += contribution;
     }
 
     // --- Point lights (with cubemap shadows) ---
     vec3 pointResult = vec3(0.0);
-    for (int i = 0; i < uNumPointLights; i++) {
-        vec3 lightVec = uPointPos[i] - fragPos;
+    for (int i = 0; i < uLightCounts.y; i++) {
+        vec3 lightVec = uPoints[i].position.xyz - fragPos;
         float dist = length(lightVec);
         vec3 lightDir = normalize(lightVec);
 
         // Attenuation: 1 / (constant + linear*d + quadratic*d^2)
-        float attenuation = 1.0 / (uPointConstant[i] + uPointLinear[i] * dist
-                                    + uPointQuadratic[i] * dist * dist);
+        vec3 atten = uPoints[i].attenuation.xyz;
+        float attenuation = 1.0 / (atten.x + atten.y * dist + atten.z * dist * dist);
 
         // Diffuse + specular
         float diff = max(dot(normal, lightDir), 0.0);
@@ -183,13 +163,13 @@ void main()
 
         // Cubemap shadow (for first MAX_POINT_SHADOW_LIGHTS lights)
         float pointShadow = 0.0;
-        if (i < uNumPointShadowLights) {
-            vec3 fragToLight = fragPos - uPointPos[i];
-            pointShadow = CalcPointShadow(i, fragToLight, dist, uPointFarPlane[i]);
+        if (i < uLightCounts.z) {
+            vec3 fragToLight = fragPos - uPoints[i].position.xyz;
+            pointShadow = CalcPointShadow(i, fragToLight, dist, uPoints[i].color.w);
         }
 
         vec3 contribution = (1.0 - pointShadow) * (diff * texColor + spec * vec3(0.3))
-                           * uPointColor[i] * uPointIntensity[i] * attenuation;
+                           * uPoints[i].color.rgb * uPoints[i].position.w * attenuation;
         pointResult += contribution;
     }
 
@@ -2,15 +2,15 @@
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aUV;
+layout (location = 3) in mat4 aInstanceModel;
 
 uniform mat4 uModel;
+uniform bool uInstanced;
 uniform mat4 uView;
 uniform mat4 uProjection;
-uniform mat4 uSunLightSpaceMVP;
 
-#define MAX_SPOT_LIGHTS 4
-uniform mat4 uSpotLightSpaceMVP[MAX_SPOT_LIGHTS];
-uniform int uNumSpotLights;
+#include "lighting_block.glsl"
+#include "terrain_block.glsl"
 
 out vec3 fragPos;
 out vec3 fragNormal;
@@ -20,15 +20,21 @@ out vec4 fragPosSpotSpace[MAX_SPOT_LIGHTS];
 
 void main()
 {
-    vec4 worldPos = uModel * vec4(aPos, 1.0);
+    vec4 worldPos;
+    if (uTerrain) {
+        TerrainVertex(aPos.xz, worldPos, fragNormal, texCoord);
+    } else {
+        mat4 model = uInstanced ? aInstanceModel : uModel;
+        worldPos = model * vec4(aPos, 1.0);
+        fragNormal = mat3(transpose(inverse(model))) * aNormal;
+        texCoord = aUV;
+    }
     fragPos = worldPos.xyz;
-    fragNormal = mat3(transpose(inverse(uModel))) * aNormal;
-    texCoord = aUV;
 
     fragPosLightSpace = uSunLightSpaceMVP * worldPos;
 
-    for (int i = 0; i < uNumSpotLights; i++) {
-        fragPosSpotSpace[i] = uSpotLightSpaceMVP[i] * worldPos;
+    for (int i = 0; i < uLightCounts.x; i++) {
+        fragPosSpotSpace[i] = uSpots[i].lightSpaceMVP * worldPos;
     }
 
     gl_Position = uProjection * uView * worldPos;
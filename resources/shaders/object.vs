@@ -2,13 +2,16 @@
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec3 aNormal;
 layout (location = 2) in vec2 aUV;
+layout (location = 3) in mat4 aInstanceModel;
 
 uniform mat4 uMVP;
+uniform bool uInstanced;
 
 out vec2 texCoord;
 
 void main()
 {
     texCoord = aUV;
-    gl_Position = uMVP * vec4(aPos, 1.0);
+    vec4 pos = uInstanced ? aInstanceModel * vec4(aPos, 1.0) : vec4(aPos, 1.0);
+    gl_Position = uMVP * pos;
 }
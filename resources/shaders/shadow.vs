@@ -1,9 +1,18 @@
 #version 330 core
 layout (location = 0) in vec3 aPos;
+layout (location = 3) in mat4 aInstanceModel;
 
 uniform mat4 uLightMVP;
+uniform bool uInstanced;
+
+#include "terrain_block.glsl"
 
 void main()
 {
-    gl_Position = uLightMVP * vec4(aPos, 1.0);
+    vec4 pos;
+    if (uTerrain)
+        pos = TerrainPosition(aPos.xz);
+    else
+        pos = uInstanced ? aInstanceModel * vec4(aPos, 1.0) : vec4(aPos, 1.0);
+    gl_Position = uLightMVP * pos;
 }
@@ -1,14 +1,15 @@
 #version 330 core
 layout (location = 0) in vec3 aPos;
-layout (location = 1) in vec3 aNormal;
-layout (location = 2) in vec2 aUV;
 
 uniform mat4 uMVP;
 
+#include "terrain_block.glsl"
+
 out vec2 texCoord;
 
 void main()
 {
-    texCoord = aUV;
-    gl_Position = uMVP * vec4(aPos, 1.0);
+    vec4 worldPos = TerrainPosition(aPos.xz);
+    texCoord = (worldPos.xz - uTerrainExtent.xy) / uTerrainExtent.z;
+    gl_Position = uMVP * worldPos;
 }
@@ -0,0 +1,52 @@
+// CDLOD terrain vertices — mirrors the node and patch layout in include/scenes/terrain.hpp.
+// Terrain::DrawGeometry sets these per pass, tile and node; aPos.xz holds the patch grid index.
+#define TERRAIN_PATCH_RES 32.0
+
+uniform bool uTerrain;
+uniform sampler2D uHeightmap;
+uniform vec3 uTerrainExtent;    // xy min corner (world XZ), z size; the whole terrain or one streamed tile
+uniform vec4 uHeightmapRect;    // xy world XZ of sample 0, z sample spacing, w samples per side
+uniform vec3 uTerrainNode;      // xy min corner (world XZ), z size
+uniform vec2 uTerrainMorph;     // distances where morphing to the coarser level starts and ends
+uniform vec3 uLodOrigin;
+
+float TerrainHeight(vec2 xz)
+{
+    vec2 uv = ((xz - uHeightmapRect.xy) / uHeightmapRect.z + 0.5) / uHeightmapRect.w;
+    return textureLod(uHeightmap, uv, 0.0).r;
+}
+
+vec2 TerrainGridXZ(vec2 grid)
+{
+    vec2 xz = uTerrainNode.xy + grid * (uTerrainNode.z / TERRAIN_PATCH_RES);
+    float dist = distance(uLodOrigin, vec3(xz.x, TerrainHeight(xz), xz.y));
+    float morph = clamp((dist - uTerrainMorph.x) / (uTerrainMorph.y - uTerrainMorph.x), 0.0, 1.0);
+
+    // Odd grid vertices slide onto their even neighbours, which is the next coarser level's grid
+    vec2 odd = fract(grid * 0.5) * 2.0;
+    xz -= odd * (uTerrainNode.z / TERRAIN_PATCH_RES) * morph;
+
+    // Parts of edge nodes past the terrain (or tile) collapse onto its border
+    return clamp(xz, uTerrainExtent.xy, uTerrainExtent.xy + uTerrainExtent.z);
+}
+
+vec4 TerrainPosition(vec2 grid)
+{
+    vec2 xz = TerrainGridXZ(grid);
+    return vec4(xz.x, TerrainHeight(xz), xz.y, 1.0);
+}
+
+void TerrainVertex(vec2 grid, out vec4 worldPos, out vec3 normal, out vec2 uv)
+{
+    vec2 xz = TerrainGridXZ(grid);
+    worldPos = vec4(xz.x, TerrainHeight(xz), xz.y, 1.0);
+
+    // Central differences over neighbouring samples; the heightmap's border covers the edges
+    float spacing = uHeightmapRect.z;
+    float hL = TerrainHeight(xz - vec2(spacing, 0.0));
+    float hR = TerrainHeight(xz + vec2(spacing, 0.0));
+    float hD = TerrainHeight(xz - vec2(0.0, spacing));
+    float hU = TerrainHeight(xz + vec2(0.0, spacing));
+    normal = normalize(vec3(hL - hR, 2.0 * spacing, hD - hU));
+    uv = (xz - uTerrainExtent.xy) / uTerrainExtent.z;
+}
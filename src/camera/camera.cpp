@@ -1,4 +1,5 @@
 #include "camera/camera.hpp"
+#include "utils/replay.hpp"
 #include <cmath>
 
 Camera::Camera(glm::vec3 startPos) : position(startPos) {
@@ -27,6 +28,7 @@ void Camera::ProcessMouse(GLFWwindow* window) {
 
     float deltaX = (float)mouseX - centerX;
     float deltaY = centerY - (float)mouseY;
+    Replay::FilterMouseDelta(deltaX, deltaY);
 
     glfwSetCursorPos(window, centerX, centerY);
 
@@ -43,7 +45,7 @@ void Camera::ProcessMouse(GLFWwindow* window) {
 }
 
 void Camera::ProcessKeyboard(GLFWwindow* window, float deltaTime) {
-    if (glfwGetKey(window, GLFW_KEY_LEFT_SHIFT) == GLFW_PRESS)
+    if (Replay::KeyDown(window, GLFW_KEY_LEFT_SHIFT))
         speed = glm::min(speed + speedAcceleration * deltaTime, maxSpeed);
     else
         speed = 5.0f;
@@ -56,22 +58,22 @@ void Camera::ProcessKeyboard(GLFWwindow* window, float deltaTime) {
     glm::vec3 rolledUp = glm::vec3(rollMat * glm::vec4(worldUp, 0.0f));
     glm::vec3 right = glm::normalize(glm::cross(direction, rolledUp));
 
-    if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+    if (Replay::KeyDown(window, GLFW_KEY_W))
         position += direction * velocity;
-    if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+    if (Replay::KeyDown(window, GLFW_KEY_S))
         position -= direction * velocity;
-    if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+    if (Replay::KeyDown(window, GLFW_KEY_A))
         position -= right * velocity;
-    if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+    if (Replay::KeyDown(window, GLFW_KEY_D))
         position += right * velocity;
-    if (glfwGetKey(window, GLFW_KEY_SPACE) == GLFW_PRESS)
+    if (Replay::KeyDown(window, GLFW_KEY_SPACE))
         position += rolledUp * velocity;
-    if (glfwGetKey(window, GLFW_KEY_LEFT_CONTROL) == GLFW_PRESS)
+    if (Replay::KeyDown(window, GLFW_KEY_LEFT_CONTROL))
         position -= rolledUp * velocity;
 
     // Roll: Q = roll left, E = roll right
-    if (glfwGetKey(window, GLFW_KEY_Q) == GLFW_PRESS)
+    if (Replay::KeyDown(window, GLFW_KEY_Q))
         roll += rollSpeed * deltaTime;
-    if (glfwGetKey(window, GLFW_KEY_E) == GLFW_PRESS)
+    if (Replay::KeyDown(window, GLFW_KEY_E))
         roll -= rollSpeed * deltaTime;
 }
@@ -0,0 +1,162 @@
+#include "collision/aabb_soa.hpp"
+#include <algorithm>
+#include <cfloat>
+
+// Blocks tested per kernel call in Overlaps, so a hit can stop the scan early
+#define AABB_SOA_CHUNK_BLOCKS 32
+
+SimdLevel AABBSoA::level = DetectSimdLevel();
+
+namespace {
+
+struct SoAView {
+    const float* minX; const float* minY; const float* minZ;
+    const float* maxX; const float* maxY; const float* maxZ;
+};
+
+using OverlapKernel = void (*)(const SoAView& v, const AABB& q, int firstBlock, int blockCount,
+                               uint8_t* masks);
+
+void OverlapScalar(const SoAView& v, const AABB& q, int firstBlock, int blockCount, uint8_t* masks) {
+    for (int b = 0; b < blockCount; b++) {
+        int base = (firstBlock + b) * AABB_SOA_BLOCK;
+        unsigned int mask = 0;
+        for (int j = 0; j < AABB_SOA_BLOCK; j++) {
+            int i = base + j;
+            // Non-short-circuit ANDs keep this branch-free
+            unsigned int hit = (q.min.x <= v.maxX[i]) & (q.max.x >= v.minX[i]) &
+                               (q.min.y <= v.maxY[i]) & (q.max.y >= v.minY[i]) &
+                               (q.min.z <= v.maxZ[i]) & (q.max.z >= v.minZ[i]);
+            mask |= hit << j;
+        }
+        masks[b] = (uint8_t)mask;
+    }
+}
+
+#ifdef SIMD_X86
+
+SIMD_TARGET("sse2")
+void OverlapSSE(const SoAView& v, const AABB& q, int firstBlock, int blockCount, uint8_t* masks) {
+    __m128 qMinX = _mm_set1_ps(q.min.x), qMaxX = _mm_set1_ps(q.max.x);
+    __m128 qMinY = _mm_set1_ps(q.min.y), qMaxY = _mm_set1_ps(q.max.y);
+    __m128 qMinZ = _mm_set1_ps(q.min.z), qMaxZ = _mm_set1_ps(q.max.z);
+
+    for (int b = 0; b < blockCount; b++) {
+        int base = (firstBlock + b) * AABB_SOA_BLOCK;
+        unsigned int mask = 0;
+        for (int half = 0; half < 2; half++) {
+            int i = base + half * 4;
+            __m128 hit = _mm_and_ps(_mm_cmple_ps(qMinX, _mm_load_ps(v.maxX + i)),
+                                    _mm_cmpge_ps(qMaxX, _mm_load_ps(v.minX + i)));
+            hit = _mm_and_ps(hit, _mm_cmple_ps(qMinY, _mm_load_ps(v.maxY + i)));
+            hit = _mm_and_ps(hit, _mm_cmpge_ps(qMaxY, _mm_load_ps(v.minY + i)));
+            hit = _mm_and_ps(hit, _mm_cmple_ps(qMinZ, _mm_load_ps(v.maxZ + i)));
+            hit = _mm_and_ps(hit, _mm_cmpge_ps(qMaxZ, _mm_load_ps(v.minZ + i)));
+            mask |= (unsigned int)_mm_movemask_ps(hit) << (half * 4);
+        }
+        masks[b] = (uint8_t)mask;
+    }
+}
+
+SIMD_TARGET("avx2")
+void OverlapAVX2(const SoAView& v, const AABB& q, int firstBlock, int blockCount, uint8_t* masks) {
+    __m256 qMinX = _mm256_set1_ps(q.min.x), qMaxX = _mm256_set1_ps(q.max.x);
+    __m256 qMinY = _mm256_set1_ps(q.min.y), qMaxY = _mm256_set1_ps(q.max.y);
+    __m256 qMinZ = _mm256_set1_ps(q.min.z), qMaxZ = _mm256_set1_ps(q.max.z);
+
+    for (int b = 0; b < blockCount; b++) {
+        int i = (firstBlock + b) * AABB_SOA_BLOCK;
+        __m256 hit = _mm256_and_ps(_mm256_cmp_ps(qMinX, _mm256_load_ps(v.maxX + i), _CMP_LE_OQ),
+                                   _mm256_cmp_ps(qMaxX, _mm256_load_ps(v.minX + i), _CMP_GE_OQ));
+        hit = _mm256_and_ps(hit, _mm256_cmp_ps(qMinY, _mm256_load_ps(v.maxY + i), _CMP_LE_OQ));
+        hit = _mm256_and_ps(hit, _mm256_cmp_ps(qMaxY, _mm256_load_ps(v.minY + i), _CMP_GE_OQ));
+        hit = _mm256_and_ps(hit, _mm256_cmp_ps(qMinZ, _mm256_load_ps(v.maxZ + i), _CMP_LE_OQ));
+        hit = _mm256_and_ps(hit, _mm256_cmp_ps(qMaxZ, _mm256_load_ps(v.minZ + i), _CMP_GE_OQ));
+        masks[b] = (uint8_t)_mm256_movemask_ps(hit);
+    }
+}
+
+#endif
+
+OverlapKernel KernelFor(SimdLevel level) {
+#ifdef SIMD_X86
+    if (level == SimdLevel::AVX2) return OverlapAVX2;
+    if (level == SimdLevel::SSE) return OverlapSSE;
+#endif
+    return OverlapScalar;
+}
+
+}
+
+// Storage
+
+int AABBSoA::Add(const AABB& box) {
+    if (count == (int)minX.size()) {
+        // Grow by a whole block of empty boxes that can never overlap anything
+        size_t size = minX.size() + AABB_SOA_BLOCK;
+        minX.resize(size, FLT_MAX); minY.resize(size, FLT_MAX); minZ.resize(size, FLT_MAX);
+        maxX.resize(size, -FLT_MAX); maxY.resize(size, -FLT_MAX); maxZ.resize(size, -FLT_MAX);
+    }
+    Set(count, box);
+    return count++;
+}
+
+void AABBSoA::Set(int index, const AABB& box) {
+    minX[index] = box.min.x; minY[index] = box.min.y; minZ[index] = box.min.z;
+    maxX[index] = box.max.x; maxY[index] = box.max.y; maxZ[index] = box.max.z;
+}
+
+AABB AABBSoA::Get(int index) const {
+    return { glm::vec3(minX[index], minY[index], minZ[index]),
+             glm::vec3(maxX[index], maxY[index], maxZ[index]) };
+}
+
+void AABBSoA::Clear() {
+    minX.clear(); minY.clear(); minZ.clear();
+    maxX.clear(); maxY.clear(); maxZ.clear();
+    count = 0;
+}
+
+// Queries
+
+void AABBSoA::OverlapMasks(const AABB& query, uint8_t* masks) const {
+    OverlapMasks(query, masks, level);
+}
+
+void AABBSoA::OverlapMasks(const AABB& query, uint8_t* masks, SimdLevel kernelLevel) const {
+    SoAView view = { minX.data(), minY.data(), minZ.data(), maxX.data(), maxY.data(), maxZ.data() };
+    KernelFor(kernelLevel)(view, query, 0, BlockCount(), masks);
+}
+
+bool AABBSoA::Overlaps(const AABB& query, int ignoreIndex) const {
+    SoAView view = { minX.data(), minY.data(), minZ.data(), maxX.data(), maxY.data(), maxZ.data() };
+    OverlapKernel kernel = KernelFor(level);
+    uint8_t masks[AABB_SOA_CHUNK_BLOCKS];
+
+    int blocks = BlockCount();
+    for (int first = 0; first < blocks; first += AABB_SOA_CHUNK_BLOCKS) {
+        int n = std::min(AABB_SOA_CHUNK_BLOCKS, blocks - first);
+        kernel(view, query, first, n, masks);
+        for (int b = 0; b < n; b++) {
+            unsigned int mask = masks[b];
+            int ignoreBit = ignoreIndex - (first + b) * AABB_SOA_BLOCK;
+            if (ignoreBit >= 0 && ignoreBit < AABB_SOA_BLOCK) mask &= ~(1u << ignoreBit);
+            if (mask) return true;
+        }
+    }
+    return false;
+}
+
+void AABBSoA::Query(const AABB& query, std::vector<int>& out) const {
+    scratch.resize(BlockCount());
+    OverlapMasks(query, scratch.data());
+    for (int b = 0; b < (int)scratch.size(); b++) {
+        unsigned int mask = scratch[b];
+        while (mask) {
+            int j = 0;
+            while (!(mask & (1u << j))) j++;
+            out.push_back(b * AABB_SOA_BLOCK + j);
+            mask &= mask - 1;
+        }
+    }
+}
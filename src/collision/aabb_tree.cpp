@@ -0,0 +1,329 @@
+#include "collision/aabb_tree.hpp"
+#include <algorithm>
+
+AABBTree::AABBTree() {
+    nodes.reserve(64);
+}
+
+// Nodes
+
+int AABBTree::AllocateNode() {
+    if (freeList == NullNode) {
+        nodes.push_back({});
+        freeList = (int)nodes.size() - 1;
+        nodes[freeList].parent = NullNode;
+    }
+
+    int node = freeList;
+    freeList = nodes[node].parent;
+    nodes[node].parent = NullNode;
+    nodes[node].child1 = NullNode;
+    nodes[node].child2 = NullNode;
+    nodes[node].height = 0;
+    return node;
+}
+
+void AABBTree::FreeNode(int node) {
+    nodes[node].parent = freeList;
+    nodes[node].height = -1;
+    freeList = node;
+}
+
+void AABBTree::Clear() {
+    nodes.clear();
+    root = NullNode;
+    freeList = NullNode;
+    proxyCount = 0;
+}
+
+// Proxies
+
+static AABB Fatten(const AABB& box) {
+    glm::vec3 margin(AABB_TREE_FAT_MARGIN);
+    return { box.min - margin, box.max + margin };
+}
+
+int AABBTree::CreateProxy(const AABB& box, int userData) {
+    int proxy = AllocateNode();
+    nodes[proxy].box = box;
+    nodes[proxy].userData = userData;
+    nodes[proxy].fat = Fatten(box);
+    InsertLeaf(proxy);
+    proxyCount++;
+    return proxy;
+}
+
+void AABBTree::DestroyProxy(int proxy) {
+    RemoveLeaf(proxy);
+    FreeNode(proxy);
+    proxyCount--;
+}
+
+bool AABBTree::MoveProxy(int proxy, const AABB& box, const glm::vec3& displacement) {
+    Node& node = nodes[proxy];
+    node.box = box;
+
+    // Still inside the fat box, and the fat box isn't oversized from an earlier fast move
+    AABB fat = Fatten(box);
+    if (node.fat.Contains(box)) {
+        glm::vec3 bigMargin(4.0f * AABB_TREE_FAT_MARGIN);
+        AABB huge = { fat.min - bigMargin, fat.max + bigMargin };
+        if (huge.Contains(node.fat)) return false;
+    }
+
+    // Stretch towards where the box is heading
+    glm::vec3 d = displacement * AABB_TREE_DISPLACEMENT_MULTIPLIER;
+    for (int axis = 0; axis < 3; axis++) {
+        if (d[axis] < 0.0f) fat.min[axis] += d[axis];
+        else fat.max[axis] += d[axis];
+    }
+
+    RemoveLeaf(proxy);
+    nodes[proxy].fat = fat;
+    InsertLeaf(proxy);
+    return true;
+}
+
+// Structure
+
+void AABBTree::InsertLeaf(int leaf) {
+    if (root == NullNode) {
+        root = leaf;
+        nodes[root].parent = NullNode;
+        return;
+    }
+
+    // Descend towards the sibling with the lowest surface area cost
+    AABB leafBox = nodes[leaf].fat;
+    int index = root;
+    while (!nodes[index].IsLeaf()) {
+        const Node& node = nodes[index];
+        float area = node.fat.SurfaceArea();
+        float combinedArea = Combine(node.fat, leafBox).SurfaceArea();
+
+        // Cost of pairing with this node, and the increase every descendant pairing inherits
+        float cost = 2.0f * combinedArea;
+        float inheritance = 2.0f * (combinedArea - area);
+
+        auto childCost = [&](int child) {
+            const Node& c = nodes[child];
+            float enlarged = Combine(c.fat, leafBox).SurfaceArea();
+            return c.IsLeaf() ? enlarged + inheritance
+                              : enlarged - c.fat.SurfaceArea() + inheritance;
+        };
+        float cost1 = childCost(node.child1);
+        float cost2 = childCost(node.child2);
+
+        if (cost < cost1 && cost < cost2) break;
+        index = cost1 < cost2 ? node.child1 : node.child2;
+    }
+
+    int sibling = index;
+    int oldParent = nodes[sibling].parent;
+    int newParent = AllocateNode();
+    nodes[newParent].parent = oldParent;
+    nodes[newParent].fat = Combine(leafBox, nodes[sibling].fat);
+    nodes[newParent].height = nodes[sibling].height + 1;
+    nodes[newParent].child1 = sibling;
+    nodes[newParent].child2 = leaf;
+    nodes[sibling].parent = newParent;
+    nodes[leaf].parent = newParent;
+
+    if (oldParent != NullNode) {
+        if (nodes[oldParent].child1 == sibling) nodes[oldParent].child1 = newParent;
+        else nodes[oldParent].child2 = newParent;
+    } else {
+        root = newParent;
+    }
+
+    Refit(nodes[leaf].parent);
+}
+
+void AABBTree::RemoveLeaf(int leaf) {
+    if (leaf == root) {
+        root = NullNode;
+        return;
+    }
+
+    int parent = nodes[leaf].parent;
+    int grandParent = nodes[parent].parent;
+    int sibling = nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1;
+
+    if (grandParent != NullNode) {
+        if (nodes[grandParent].child1 == parent) nodes[grandParent].child1 = sibling;
+        else nodes[grandParent].child2 = sibling;
+        nodes[sibling].parent = grandParent;
+        FreeNode(parent);
+        Refit(grandParent);
+    } else {
+        root = sibling;
+        nodes[sibling].parent = NullNode;
+        FreeNode(parent);
+    }
+}
+
+// Walk to the root, rebalancing and recomputing boxes and heights on the way
+void AABBTree::Refit(int index) {
+    while (index != NullNode) {
+        index = Balance(index);
+
+        Node& node = nodes[index];
+        const Node& c1 = nodes[node.child1];
+        const Node& c2 = nodes[node.child2];
+        node.height = 1 + std::max(c1.height, c2.height);
+        node.fat = Combine(c1.fat, c2.fat);
+
+        index = node.parent;
+    }
+}
+
+// If one child of A is more than one level taller than the other, rotate it up.
+// Returns the index of the node now in A's place.
+int AABBTree::Balance(int iA) {
+    Node& A = nodes[iA];
+    if (A.IsLeaf() || A.height < 2) return iA;
+
+    int iB = A.child1;
+    int iC = A.child2;
+    Node& B = nodes[iB];
+    Node& C = nodes[iC];
+
+    int balance = C.height - B.height;
+
+    // Rotate C up
+    if (balance > 1) {
+        int iF = C.child1;
+        int iG = C.child2;
+        Node& F = nodes[iF];
+        Node& G = nodes[iG];
+
+        C.child1 = iA;
+        C.parent = A.parent;
+        A.parent = iC;
+
+        if (C.parent != NullNode) {
+            if (nodes[C.parent].child1 == iA) nodes[C.parent].child1 = iC;
+            else nodes[C.parent].child2 = iC;
+        } else {
+            root = iC;
+        }
+
+        if (F.height > G.height) {
+            C.child2 = iF;
+            A.child2 = iG;
+            G.parent = iA;
+            A.fat = Combine(B.fat, G.fat);
+            C.fat = Combine(A.fat, F.fat);
+            A.height = 1 + std::max(B.height, G.height);
+            C.height = 1 + std::max(A.height, F.height);
+        } else {
+            C.child2 = iG;
+            A.child2 = iF;
+            F.parent = iA;
+            A.fat = Combine(B.fat, F.fat);
+            C.fat = Combine(A.fat, G.fat);
+            A.height = 1 + std::max(B.height, F.height);
+            C.height = 1 + std::max(A.height, G.height);
+        }
+        return iC;
+    }
+
+    // Rotate B up
+    if (balance < -1) {
+        int iD = B.child1;
+        int iE = B.child2;
+        Node& D = nodes[iD];
+        Node& E = nodes[iE];
+
+        B.child1 = iA;
+        B.parent = A.parent;
+        A.parent = iB;
+
+        if (B.parent != NullNode) {
+            if (nodes[B.parent].child1 == iA) nodes[B.parent].child1 = iB;
+            else nodes[B.parent].child2 = iB;
+        } else {
+            root = iB;
+        }
+
+        if (D.height > E.height) {
+            B.child2 = iD;
+            A.child1 = iE;
+            E.parent = iA;
+            A.fat = Combine(C.fat, E.fat);
+            B.fat = Combine(A.fat, D.fat);
+            A.height = 1 + std::max(C.height, E.height);
+            B.height = 1 + std::max(A.height, D.height);
+        } else {
+            B.child2 = iE;
+            A.child1 = iD;
+            D.parent = iA;
+            A.fat = Combine(C.fat, D.fat);
+            B.fat = Combine(A.fat, E.fat);
+            A.height = 1 + std::max(C.height, D.height);
+            B.height = 1 + std::max(A.height, E.height);
+        }
+        return iB;
+    }
+
+    return iA;
+}
+
+// Tight-box queries
+
+bool AABBTree::Overlaps(const AABB& box, int ignoreProxy) const {
+    bool hit = false;
+    Query(box, [&](int proxy) {
+        if (proxy != ignoreProxy && nodes[proxy].box.Overlaps(box)) hit = true;
+        return !hit;
+    });
+    return hit;
+}
+
+void AABBTree::Query(const AABB& box, std::vector<int>& out) const {
+    Query(box, [&](int proxy) {
+        if (nodes[proxy].box.Overlaps(box)) out.push_back(proxy);
+        return true;
+    });
+}
+
+int AABBTree::RayCastClosest(const glm::vec3& from, const glm::vec3& to, float& tHit) const {
+    int closest = -1;
+    glm::vec3 delta = to - from;
+    RayCast(from, to, [&](int proxy, float maxT) {
+        float t;
+        if (!SegmentIntersects(nodes[proxy].box, from, delta, maxT, t)) return maxT;
+        closest = proxy;
+        tHit = t;
+        // Zero would stop the cast; a hit at the start can't be beaten anyway
+        return t > 0.0f ? t : 0.0f;
+    });
+    return closest;
+}
+
+void AABBTree::QueryPairs(std::vector<std::pair<int, int>>& out) const {
+    // One tree query per leaf: O(n log n) for scenes where each box touches a few others
+    for (int i = 0; i < (int)nodes.size(); i++) {
+        const Node& node = nodes[i];
+        if (node.height != 0) continue;  // internal or free
+        Query(node.box, [&](int other) {
+            if (other > i && nodes[other].box.Overlaps(node.box)) out.push_back({ i, other });
+            return true;
+        });
+    }
+}
+
+bool AABBTree::Sweep(const AABB& box, const glm::vec3& delta, SweepHit& hit, int ignoreProxy) const {
+    bool found = false;
+    Query(SweptBounds(box, delta), [&](int proxy) {
+        SweepHit candidate;
+        if (proxy != ignoreProxy && SweepAABB(box, delta, nodes[proxy].box, candidate) &&
+            (!found || candidate.t < hit.t)) {
+            hit = candidate;
+            hit.id = proxy;
+            found = true;
+        }
+        return true;
+    });
+    return found;
+}
@@ -0,0 +1,277 @@
+#include "collision/obb_soa.hpp"
+
+namespace {
+
+struct OBBView {
+    const float* center[3];
+    const float* axes[3][3];
+    const float* half[3];
+};
+
+// Narrows per-block bounds hit masks in place; blocks with no bounds hit are skipped.
+// Every kernel evaluates the same expressions in the same order as OBBOverlaps(query, box),
+// so all levels agree bit for bit.
+using SatKernel = void (*)(const OBBView& v, const OBB& q, int firstBlock, int blockCount, uint8_t* masks);
+
+OBB LaneBox(const OBBView& v, int i) {
+    OBB box;
+    for (int c = 0; c < 3; c++) {
+        box.center[c] = v.center[c][i];
+        box.half[c] = v.half[c][i];
+        for (int a = 0; a < 3; a++) box.axes[a][c] = v.axes[a][c][i];
+    }
+    return box;
+}
+
+void SatScalar(const OBBView& v, const OBB& q, int firstBlock, int blockCount, uint8_t* masks) {
+    for (int b = 0; b < blockCount; b++) {
+        unsigned int mask = masks[b];
+        int base = (firstBlock + b) * AABB_SOA_BLOCK;
+        for (unsigned int bits = mask; bits; bits &= bits - 1) {
+            int j = 0;
+            while (!(bits & (1u << j))) j++;
+            if (!OBBOverlaps(q, LaneBox(v, base + j))) mask &= ~(1u << j);
+        }
+        masks[b] = (uint8_t)mask;
+    }
+}
+
+#ifdef SIMD_X86
+
+// 4 lanes starting at box i; returns the lanes with a separating axis
+SIMD_TARGET("sse2")
+unsigned int SeparatedSSE(const OBBView& v, const __m128 (&qa)[3][3], const __m128 (&qc)[3],
+                          const __m128 (&qh)[3], int i) {
+    const __m128 signBit = _mm_set1_ps(-0.0f);
+    const __m128 eps = _mm_set1_ps(OBB_SAT_EPSILON);
+
+    __m128 R[3][3], absR[3][3], d[3], bh[3], t[3];
+    for (int c = 0; c < 3; c++) {
+        d[c] = _mm_sub_ps(_mm_load_ps(v.center[c] + i), qc[c]);
+        bh[c] = _mm_load_ps(v.half[c] + i);
+    }
+    for (int j = 0; j < 3; j++) {
+        __m128 bx = _mm_load_ps(v.axes[j][0] + i), by = _mm_load_ps(v.axes[j][1] + i), bz = _mm_load_ps(v.axes[j][2] + i);
+        for (int k = 0; k < 3; k++) {
+            R[k][j] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(qa[k][0], bx), _mm_mul_ps(qa[k][1], by)), _mm_mul_ps(qa[k][2], bz));
+            absR[k][j] = _mm_add_ps(_mm_andnot_ps(signBit, R[k][j]), eps);
+        }
+    }
+    for (int k = 0; k < 3; k++)
+        t[k] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(d[0], qa[k][0]), _mm_mul_ps(d[1], qa[k][1])), _mm_mul_ps(d[2], qa[k][2]));
+
+    __m128 sep = _mm_setzero_ps();
+    for (int k = 0; k < 3; k++) {
+        __m128 rb = _mm_add_ps(_mm_add_ps(_mm_mul_ps(bh[0], absR[k][0]), _mm_mul_ps(bh[1], absR[k][1])),
+                               _mm_mul_ps(bh[2], absR[k][2]));
+        sep = _mm_or_ps(sep, _mm_cmpgt_ps(_mm_andnot_ps(signBit, t[k]), _mm_add_ps(qh[k], rb)));
+    }
+    for (int j = 0; j < 3; j++) {
+        __m128 ra = _mm_add_ps(_mm_add_ps(_mm_mul_ps(qh[0], absR[0][j]), _mm_mul_ps(qh[1], absR[1][j])),
+                               _mm_mul_ps(qh[2], absR[2][j]));
+        __m128 s = _mm_add_ps(_mm_add_ps(_mm_mul_ps(t[0], R[0][j]), _mm_mul_ps(t[1], R[1][j])), _mm_mul_ps(t[2], R[2][j]));
+        sep = _mm_or_ps(sep, _mm_cmpgt_ps(_mm_andnot_ps(signBit, s), _mm_add_ps(ra, bh[j])));
+    }
+    if (_mm_movemask_ps(sep) == 0xF) return 0xF;
+
+    for (int k = 0; k < 3; k++) {
+        int k1 = (k + 1) % 3, k2 = (k + 2) % 3;
+        for (int j = 0; j < 3; j++) {
+            int j1 = (j + 1) % 3, j2 = (j + 2) % 3;
+            __m128 ra = _mm_add_ps(_mm_mul_ps(qh[k1], absR[k2][j]), _mm_mul_ps(qh[k2], absR[k1][j]));
+            __m128 rb = _mm_add_ps(_mm_mul_ps(bh[j1], absR[k][j2]), _mm_mul_ps(bh[j2], absR[k][j1]));
+            __m128 s = _mm_sub_ps(_mm_mul_ps(t[k2], R[k1][j]), _mm_mul_ps(t[k1], R[k2][j]));
+            sep = _mm_or_ps(sep, _mm_cmpgt_ps(_mm_andnot_ps(signBit, s), _mm_add_ps(ra, rb)));
+        }
+    }
+    return (unsigned int)_mm_movemask_ps(sep);
+}
+
+SIMD_TARGET("sse2")
+void SatSSE(const OBBView& v, const OBB& q, int firstBlock, int blockCount, uint8_t* masks) {
+    __m128 qa[3][3], qc[3], qh[3];
+    for (int c = 0; c < 3; c++) {
+        qc[c] = _mm_set1_ps(q.center[c]);
+        qh[c] = _mm_set1_ps(q.half[c]);
+        for (int k = 0; k < 3; k++) qa[k][c] = _mm_set1_ps(q.axes[k][c]);
+    }
+
+    for (int b = 0; b < blockCount; b++) {
+        if (!masks[b]) continue;
+        int base = (firstBlock + b) * AABB_SOA_BLOCK;
+        unsigned int separated = 0;
+        for (int half = 0; half < 2; half++) {
+            if (!((masks[b] >> (half * 4)) & 0xF)) continue;
+            separated |= SeparatedSSE(v, qa, qc, qh, base + half * 4) << (half * 4);
+        }
+        masks[b] &= (uint8_t)~separated;
+    }
+}
+
+SIMD_TARGET("avx2")
+void SatAVX2(const OBBView& v, const OBB& q, int firstBlock, int blockCount, uint8_t* masks) {
+    const __m256 signBit = _mm256_set1_ps(-0.0f);
+    const __m256 eps = _mm256_set1_ps(OBB_SAT_EPSILON);
+    __m256 qa[3][3], qc[3], qh[3];
+    for (int c = 0; c < 3; c++) {
+        qc[c] = _mm256_set1_ps(q.center[c]);
+        qh[c] = _mm256_set1_ps(q.half[c]);
+        for (int k = 0; k < 3; k++) qa[k][c] = _mm256_set1_ps(q.axes[k][c]);
+    }
+
+    for (int b = 0; b < blockCount; b++) {
+        if (!masks[b]) continue;
+        int i = (firstBlock + b) * AABB_SOA_BLOCK;
+
+        __m256 R[3][3], absR[3][3], d[3], bh[3], t[3];
+        for (int c = 0; c < 3; c++) {
+            d[c] = _mm256_sub_ps(_mm256_load_ps(v.center[c] + i), qc[c]);
+            bh[c] = _mm256_load_ps(v.half[c] + i);
+        }
+        for (int j = 0; j < 3; j++) {
+            __m256 bx = _mm256_load_ps(v.axes[j][0] + i);
+            __m256 by = _mm256_load_ps(v.axes[j][1] + i);
+            __m256 bz = _mm256_load_ps(v.axes[j][2] + i);
+            for (int k = 0; k < 3; k++) {
+                R[k][j] = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(qa[k][0], bx), _mm256_mul_ps(qa[k][1], by)),
+                                        _mm256_mul_ps(qa[k][2], bz));
+                absR[k][j] = _mm256_add_ps(_mm256_andnot_ps(signBit, R[k][j]), eps);
+            }
+        }
+        for (int k = 0; k < 3; k++)
+            t[k] = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(d[0], qa[k][0]), _mm256_mul_ps(d[1], qa[k][1])),
+                                 _mm256_mul_ps(d[2], qa[k][2]));
+
+        // Face axes of both boxes first; most pairs that pass the bounds test separate here
+        __m256 sep = _mm256_setzero_ps();
+        for (int k = 0; k < 3; k++) {
+            __m256 rb = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(bh[0], absR[k][0]), _mm256_mul_ps(bh[1], absR[k][1])),
+                                      _mm256_mul_ps(bh[2], absR[k][2]));
+            sep = _mm256_or_ps(sep, _mm256_cmp_ps(_mm256_andnot_ps(signBit, t[k]), _mm256_add_ps(qh[k], rb), _CMP_GT_OQ));
+        }
+        for (int j = 0; j < 3; j++) {
+            __m256 ra = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(qh[0], absR[0][j]), _mm256_mul_ps(qh[1], absR[1][j])),
+                                      _mm256_mul_ps(qh[2], absR[2][j]));
+            __m256 s = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(t[0], R[0][j]), _mm256_mul_ps(t[1], R[1][j])),
+                                     _mm256_mul_ps(t[2], R[2][j]));
+            sep = _mm256_or_ps(sep, _mm256_cmp_ps(_mm256_andnot_ps(signBit, s), _mm256_add_ps(ra, bh[j]), _CMP_GT_OQ));
+        }
+        if (((_mm256_movemask_ps(sep) | ~masks[b]) & 0xFF) == 0xFF) {
+            masks[b] = 0;
+            continue;
+        }
+
+        for (int k = 0; k < 3; k++) {
+            int k1 = (k + 1) % 3, k2 = (k + 2) % 3;
+            for (int j = 0; j < 3; j++) {
+                int j1 = (j + 1) % 3, j2 = (j + 2) % 3;
+                __m256 ra = _mm256_add_ps(_mm256_mul_ps(qh[k1], absR[k2][j]), _mm256_mul_ps(qh[k2], absR[k1][j]));
+                __m256 rb = _mm256_add_ps(_mm256_mul_ps(bh[j1], absR[k][j2]), _mm256_mul_ps(bh[j2], absR[k][j1]));
+                __m256 s = _mm256_sub_ps(_mm256_mul_ps(t[k2], R[k1][j]), _mm256_mul_ps(t[k1], R[k2][j]));
+                sep = _mm256_or_ps(sep, _mm256_cmp_ps(_mm256_andnot_ps(signBit, s), _mm256_add_ps(ra, rb), _CMP_GT_OQ));
+            }
+        }
+        masks[b] &= (uint8_t)~_mm256_movemask_ps(sep);
+    }
+}
+
+#endif
+
+SatKernel KernelFor(SimdLevel level) {
+#ifdef SIMD_X86
+    if (level == SimdLevel::AVX2) return SatAVX2;
+    if (level == SimdLevel::SSE) return SatSSE;
+#endif
+    return SatScalar;
+}
+
+}
+
+// Storage
+
+int OBBSoA::Add(const OBB& box) {
+    int index = bounds.Add(box.Bounds());
+    if (index == (int)center[0].size()) {
+        // Padding lanes are never tested: their bounds can't overlap anything
+        size_t size = center[0].size() + AABB_SOA_BLOCK;
+        for (int c = 0; c < 3; c++) {
+            center[c].resize(size, 0.0f);
+            half[c].resize(size, 0.0f);
+            for (int a = 0; a < 3; a++) axes[a][c].resize(size, 0.0f);
+        }
+    }
+    Set(index, box);
+    return index;
+}
+
+void OBBSoA::Set(int index, const OBB& box) {
+    bounds.Set(index, box.Bounds());
+    for (int c = 0; c < 3; c++) {
+        center[c][index] = box.center[c];
+        half[c][index] = box.half[c];
+        for (int a = 0; a < 3; a++) axes[a][c][index] = box.axes[a][c];
+    }
+}
+
+OBB OBBSoA::Get(int index) const {
+    OBB box;
+    for (int c = 0; c < 3; c++) {
+        box.center[c] = center[c][index];
+        box.half[c] = half[c][index];
+        for (int a = 0; a < 3; a++) box.axes[a][c] = axes[a][c][index];
+    }
+    return box;
+}
+
+void OBBSoA::Clear() {
+    bounds.Clear();
+    for (int c = 0; c < 3; c++) {
+        center[c].clear();
+        half[c].clear();
+        for (int a = 0; a < 3; a++) axes[a][c].clear();
+    }
+}
+
+// Queries
+
+void OBBSoA::OverlapMasks(const OBB& query, uint8_t* masks) const {
+    OverlapMasks(query, masks, AABBSoA::level);
+}
+
+void OBBSoA::OverlapMasks(const OBB& query, uint8_t* masks, SimdLevel kernelLevel) const {
+    bounds.OverlapMasks(query.Bounds(), masks, kernelLevel);
+
+    OBBView view;
+    for (int c = 0; c < 3; c++) {
+        view.center[c] = center[c].data();
+        view.half[c] = half[c].data();
+        for (int a = 0; a < 3; a++) view.axes[a][c] = axes[a][c].data();
+    }
+    KernelFor(kernelLevel)(view, query, 0, BlockCount(), masks);
+}
+
+bool OBBSoA::Overlaps(const OBB& query, int ignoreIndex) const {
+    scratch.resize(BlockCount());
+    OverlapMasks(query, scratch.data());
+    for (int b = 0; b < (int)scratch.size(); b++) {
+        unsigned int mask = scratch[b];
+        int ignoreBit = ignoreIndex - b * AABB_SOA_BLOCK;
+        if (ignoreBit >= 0 && ignoreBit < AABB_SOA_BLOCK) mask &= ~(1u << ignoreBit);
+        if (mask) return true;
+    }
+    return false;
+}
+
+void OBBSoA::Query(const OBB& query, std::vector<int>& out) const {
+    scratch.resize(BlockCount());
+    OverlapMasks(query, scratch.data());
+    for (int b = 0; b < (int)scratch.size(); b++) {
+        unsigned int mask = scratch[b];
+        while (mask) {
+            int j = 0;
+            while (!(mask & (1u << j))) j++;
+            out.push_back(b * AABB_SOA_BLOCK + j);
+            mask &= mask - 1;
+        }
+    }
+}
@@ -0,0 +1,80 @@
+#include "collision/spatial_hash.hpp"
+#include <cmath>
+
+SpatialHash::SpatialHash(float cellSize) : cellSize(cellSize), invCellSize(1.0f / cellSize) {}
+
+unsigned int SpatialHash::Bucket(int cx, int cz) const {
+    return ((unsigned int)cx * 73856093u ^ (unsigned int)cz * 19349663u) & tableMask;
+}
+
+void SpatialHash::Build(const glm::vec3* points, int count) {
+    unsigned int tableSize = 16;
+    while (tableSize < (unsigned int)count * 2) tableSize <<= 1;
+    tableMask = tableSize - 1;
+
+    bucketStart.assign(tableSize + 1, 0);
+    pointBucket.resize(count);
+    for (int i = 0; i < count; i++) {
+        unsigned int b = Bucket((int)std::floor(points[i].x * invCellSize), (int)std::floor(points[i].z * invCellSize));
+        pointBucket[i] = b;
+        bucketStart[b + 1]++;
+    }
+    for (unsigned int b = 0; b < tableSize; b++)
+        bucketStart[b + 1] += bucketStart[b];
+
+    // Scatter in index order, so every bucket lists its points in ascending index order
+    entries.resize(count);
+    entryPos.resize(count);
+    std::vector<int> cursor(bucketStart.begin(), bucketStart.end() - 1);
+    for (int i = 0; i < count; i++) {
+        int slot = cursor[pointBucket[i]]++;
+        entries[slot] = i;
+        entryPos[slot] = glm::vec2(points[i].x, points[i].z);
+    }
+}
+
+int SpatialHash::Nearest(const glm::vec3& pos, float radius, int k, int ignore, int* out) const {
+    if (entries.empty() || k <= 0) return 0;
+
+    int cx = (int)std::floor(pos.x * invCellSize);
+    int cz = (int)std::floor(pos.z * invCellSize);
+    glm::vec2 p(pos.x, pos.z);
+    float radiusSq = radius * radius;
+
+    // Insertion into a small sorted list; k is a handful, so this beats a heap
+    float distSq[64];
+    if (k > 64) k = 64;
+    int found = 0;
+
+    unsigned int visited[9];
+    int visitedCount = 0;
+    for (int dz = -1; dz <= 1; dz++) {
+        for (int dx = -1; dx <= 1; dx++) {
+            unsigned int b = Bucket(cx + dx, cz + dz);
+            // Neighbouring cells can share a bucket; scan it once
+            bool seen = false;
+            for (int v = 0; v < visitedCount; v++) seen |= visited[v] == b;
+            if (seen) continue;
+            visited[visitedCount++] = b;
+
+            for (int e = bucketStart[b]; e < bucketStart[b + 1]; e++) {
+                glm::vec2 d = entryPos[e] - p;
+                float dSq = glm::dot(d, d);
+                if (dSq > radiusSq || entries[e] == ignore) continue;
+                // Ties go to the lower index, so the result doesn't depend on bucket layout
+                if (found == k && (dSq > distSq[k - 1] || (dSq == distSq[k - 1] && entries[e] > out[k - 1])))
+                    continue;
+
+                int i = found < k ? found++ : k - 1;
+                while (i > 0 && (distSq[i - 1] > dSq || (distSq[i - 1] == dSq && out[i - 1] > entries[e]))) {
+                    distSq[i] = distSq[i - 1];
+                    out[i] = out[i - 1];
+                    i--;
+                }
+                distSq[i] = dSq;
+                out[i] = entries[e];
+            }
+        }
+    }
+    return found;
+}
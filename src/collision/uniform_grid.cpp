@@ -0,0 +1,158 @@
+#include "collision/uniform_grid.hpp"
+#include <algorithm>
+#include <cmath>
+
+UniformGrid::UniformGrid(float cellSize) : invCellSize(1.0f / cellSize) {}
+
+UniformGrid::CellRange UniformGrid::RangeOf(const AABB& box) const {
+    return {
+        (int)std::floor(box.min.x * invCellSize), (int)std::floor(box.min.z * invCellSize),
+        (int)std::floor(box.max.x * invCellSize), (int)std::floor(box.max.z * invCellSize)
+    };
+}
+
+uint64_t UniformGrid::CellKey(int x, int z) {
+    return ((uint64_t)(uint32_t)x << 32) | (uint32_t)z;
+}
+
+void UniformGrid::AddToCells(int id, const CellRange& range) {
+    for (int x = range.x0; x <= range.x1; x++)
+        for (int z = range.z0; z <= range.z1; z++)
+            cells[CellKey(x, z)].push_back(id);
+}
+
+void UniformGrid::RemoveFromCells(int id, const CellRange& range) {
+    for (int x = range.x0; x <= range.x1; x++) {
+        for (int z = range.z0; z <= range.z1; z++) {
+            auto it = cells.find(CellKey(x, z));
+            if (it == cells.end()) continue;
+            std::vector<int>& ids = it->second;
+            auto pos = std::find(ids.begin(), ids.end(), id);
+            if (pos != ids.end()) {
+                *pos = ids.back();
+                ids.pop_back();
+            }
+            if (ids.empty()) cells.erase(it);
+        }
+    }
+}
+
+int UniformGrid::Insert(const AABB& box) {
+    int id;
+    if (!freeIds.empty()) {
+        id = freeIds.back();
+        freeIds.pop_back();
+    } else {
+        id = (int)items.size();
+        items.push_back({});
+    }
+
+    Item& item = items[id];
+    item.box = box;
+    item.range = RangeOf(box);
+    item.alive = true;
+    item.oriented = false;
+    item.queryStamp = 0;
+    AddToCells(id, item.range);
+    return id;
+}
+
+int UniformGrid::Insert(const OBB& box) {
+    if (box.IsAxisAligned()) return Insert(box.Bounds());
+
+    int id = Insert(box.Bounds());
+    if (shapes.size() <= (size_t)id) shapes.resize(id + 1);
+    shapes[id] = box;
+    items[id].oriented = true;
+    return id;
+}
+
+void UniformGrid::Update(int id, const AABB& box) {
+    Item& item = items[id];
+    item.box = box;
+    item.oriented = false;
+
+    CellRange range = RangeOf(box);
+    if (range == item.range) return;
+    RemoveFromCells(id, item.range);
+    AddToCells(id, range);
+    item.range = range;
+}
+
+void UniformGrid::Remove(int id) {
+    Item& item = items[id];
+    if (!item.alive) return;
+    RemoveFromCells(id, item.range);
+    item.alive = false;
+    freeIds.push_back(id);
+}
+
+void UniformGrid::Clear() {
+    items.clear();
+    shapes.clear();
+    freeIds.clear();
+    cells.clear();
+    queryStamp = 0;
+}
+
+bool UniformGrid::Hits(int id, const AABB& box) const {
+    const Item& item = items[id];
+    if (!box.Overlaps(item.box)) return false;
+    return !item.oriented || OBBOverlaps(OBBFromAABB(box), shapes[id]);
+}
+
+bool UniformGrid::Overlaps(const AABB& box, int ignoreId) const {
+    CellRange range = RangeOf(box);
+    for (int x = range.x0; x <= range.x1; x++) {
+        for (int z = range.z0; z <= range.z1; z++) {
+            auto it = cells.find(CellKey(x, z));
+            if (it == cells.end()) continue;
+            // A box spanning several cells may be tested twice; cheaper than deduplicating
+            for (int id : it->second)
+                if (id != ignoreId && Hits(id, box)) return true;
+        }
+    }
+    return false;
+}
+
+void UniformGrid::Query(const AABB& box, std::vector<int>& out) const {
+    // Stamp visited items so boxes spanning several cells are reported once
+    if (++queryStamp == 0) {
+        for (const auto& item : items) item.queryStamp = 0;
+        queryStamp = 1;
+    }
+
+    CellRange range = RangeOf(box);
+    for (int x = range.x0; x <= range.x1; x++) {
+        for (int z = range.z0; z <= range.z1; z++) {
+            auto it = cells.find(CellKey(x, z));
+            if (it == cells.end()) continue;
+            for (int id : it->second) {
+                const Item& item = items[id];
+                if (item.queryStamp == queryStamp) continue;
+                item.queryStamp = queryStamp;
+                if (Hits(id, box)) out.push_back(id);
+            }
+        }
+    }
+}
+
+bool UniformGrid::Sweep(const AABB& box, const glm::vec3& delta, SweepHit& hit, int ignoreId) const {
+    sweepCandidates.clear();
+    Query(SweptBounds(box, delta), sweepCandidates);
+
+    bool found = false;
+    for (int id : sweepCandidates) {
+        SweepHit candidate;
+        if (id == ignoreId) continue;
+        bool touched = items[id].oriented ? SweepOBB(box, delta, shapes[id], candidate)
+                                          : SweepAABB(box, delta, items[id].box, candidate);
+        if (!touched) continue;
+        if (!found || candidate.t < hit.t) {
+            hit = candidate;
+            hit.id = id;
+            found = true;
+        }
+    }
+    return found;
+}
@@ -1,4 +1,5 @@
 #include "display/base_window.hpp"
+#include "utils/profiler.hpp"
 #include <iostream>
 
 BaseWindow::BaseWindow() {
@@ -13,13 +14,19 @@ BaseWindow::BaseWindow(int width, int height, std::string title) {
 
 int BaseWindow::Run() {
     // Iniialize GLFW
-    glfwInit();
+    if (!glfwInit()) {
+        std::cout << "Failed to initialize GLFW" << std::endl;
+        return -1;
+    }
 
     // Run initialisation logic
     Initialize();
 
-    // Create GLFW Window
-    windowHandle = glfwCreateWindow(this->windowWidth, this->windowHeight, this->windowTitle.c_str(), NULL, NULL);
+    // Create GLFW Window (hidden, offscreen-capable context in benchmark mode)
+    if (benchmark.enabled)
+        windowHandle = CreateOffscreenWindow();
+    else
+        windowHandle = glfwCreateWindow(this->windowWidth, this->windowHeight, this->windowTitle.c_str(), NULL, NULL);
     if (windowHandle == NULL) {
         std::cout << "Failed to create GLFW window" << std::endl;
         glfwTerminate();
@@ -39,10 +46,26 @@ int BaseWindow::Run() {
     // Runs load content which might include stuff that requires an opengl context
     LoadContent();
 
+    if (benchmark.enabled) {
+        int result = RunBenchmark();
+        Unload();
+        glfwDestroyWindow(windowHandle);
+        glfwTerminate();
+        return result;
+    }
+
     // Main game loop
     while (!glfwWindowShouldClose(windowHandle)) {
-        Update();
-        Render();
+        Profiler::BeginFrame();
+        {
+            PROFILE_SCOPE("Update");
+            Update();
+        }
+        {
+            PROFILE_SCOPE("Render");
+            Render();
+        }
+        Profiler::EndFrame();
     }
 
     // Unload and destroy 
@@ -50,4 +73,28 @@ int BaseWindow::Run() {
     glfwDestroyWindow(windowHandle);
     glfwTerminate();
     return 0;
-}
\ No newline at end of file
+}
+
+GLFWwindow* BaseWindow::CreateOffscreenWindow() {
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    // Prefer OSMesa, then EGL, so llvmpipe works on boxes without a GPU. A GLFW built with
+    // GLFW_USE_OSMESA needs no display server at all; otherwise the window is simply hidden.
+    int contextApis[] = { GLFW_OSMESA_CONTEXT_API, GLFW_EGL_CONTEXT_API, GLFW_NATIVE_CONTEXT_API };
+    const char* apiNames[] = { "OSMESA", "EGL", "NATIVE" };
+    for (int i = 0; i < 3; i++) {
+        glfwWindowHint(GLFW_CONTEXT_CREATION_API, contextApis[i]);
+        GLFWwindow* window = glfwCreateWindow(this->windowWidth, this->windowHeight,
+                                              this->windowTitle.c_str(), NULL, NULL);
+        if (window) {
+            std::cout << "INFO::WINDOW::OFFSCREEN_CONTEXT(" << apiNames[i] << ")" << std::endl;
+            return window;
+        }
+    }
+    return NULL;
+}
+
+int BaseWindow::RunBenchmark() {
+    std::cout << "ERROR::WINDOW::BENCHMARK_NOT_SUPPORTED" << std::endl;
+    return -1;
+}
@@ -0,0 +1,375 @@
+#include "display/benchmark.hpp"
+#include "collision/aabb_soa.hpp"
+#include "collision/obb_soa.hpp"
+#include "scenes/noise_generator.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <bit>
+#include <fstream>
+#include <iostream>
+
+bool ParseBenchmarkArgs(int argc, char** argv, BenchmarkOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (std::strcmp(arg, "--benchmark") == 0) {
+            options.enabled = true;
+        } else if (std::strcmp(arg, "--collision-bench") == 0) {
+            options.collisionKernels = true;
+        } else if (std::strcmp(arg, "--noise-bench") == 0) {
+            options.noiseKernels = true;
+        } else if (std::strcmp(arg, "--frames") == 0 && hasValue) {
+            options.frames = std::max(1, std::atoi(argv[++i]));
+        } else if (std::strcmp(arg, "--warmup") == 0 && hasValue) {
+            options.warmupFrames = std::max(0, std::atoi(argv[++i]));
+        } else if (std::strcmp(arg, "--dt") == 0 && hasValue) {
+            options.deltaTime = (float)std::atof(argv[++i]);
+        } else if (std::strcmp(arg, "--out") == 0 && hasValue) {
+            options.outputPath = argv[++i];
+        } else if (std::strcmp(arg, "--record") == 0 && hasValue) {
+            options.recordPath = argv[++i];
+        } else if (std::strcmp(arg, "--replay") == 0 && hasValue) {
+            options.replayPath = argv[++i];
+            options.enabled = true;
+        } else if (std::strcmp(arg, "--scene") == 0 && hasValue) {
+            options.scene = std::max(0, std::atoi(argv[++i]));
+        } else {
+            std::cout << "Usage: " << argv[0]
+                      << " [--benchmark | --collision-bench | --noise-bench] [--frames N] [--warmup N] [--dt SECONDS] [--out FILE.json]"
+                      << " [--record FILE [--scene N] | --replay FILE]" << std::endl;
+            return false;
+        }
+    }
+    if (options.deltaTime <= 0.0f) {
+        std::cout << "ERROR::BENCHMARK::DELTA_TIME_MUST_BE_POSITIVE" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+static std::string JsonEscape(const std::string& s) {
+    std::string out;
+    for (char c : s) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    return out;
+}
+
+static double Percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    size_t k = (size_t)std::lround(p * (sorted.size() - 1));
+    return sorted[k];
+}
+
+bool WriteBenchmarkReport(const std::string& path, const BenchmarkOptions& options,
+                          const std::string& renderer,
+                          const std::vector<SceneBenchmarkResult>& results) {
+    std::ofstream f(path);
+    if (!f.is_open()) {
+        std::cout << "ERROR::BENCHMARK::CANNOT_WRITE_REPORT: " << path << std::endl;
+        return false;
+    }
+
+    f << "{\n";
+    f << "  \"renderer\": \"" << JsonEscape(renderer) << "\",\n";
+    f << "  \"frames\": " << options.frames << ",\n";
+    f << "  \"warmupFrames\": " << options.warmupFrames << ",\n";
+    f << "  \"deltaTime\": " << options.deltaTime << ",\n";
+    f << "  \"scenes\": [\n";
+
+    for (size_t i = 0; i < results.size(); i++) {
+        const SceneBenchmarkResult& r = results[i];
+
+        std::vector<double> sorted = r.frameMs;
+        std::sort(sorted.begin(), sorted.end());
+        double sum = 0.0;
+        for (double ms : sorted) sum += ms;
+        double n = (double)std::max<size_t>(sorted.size(), 1);
+        double mean = sum / n;
+        double var = 0.0;
+        for (double ms : sorted) var += (ms - mean) * (ms - mean);
+
+        f << "    {\n";
+        f << "      \"name\": \"" << JsonEscape(r.name) << "\",\n";
+        f << "      \"loadMs\": " << r.loadMs << ",\n";
+        f << "      \"unloadMs\": " << r.unloadMs << ",\n";
+        f << "      \"frameMs\": {\n";
+        f << "        \"mean\": " << mean << ",\n";
+        f << "        \"stddev\": " << std::sqrt(var / n) << ",\n";
+        f << "        \"min\": " << (sorted.empty() ? 0.0 : sorted.front()) << ",\n";
+        f << "        \"max\": " << (sorted.empty() ? 0.0 : sorted.back()) << ",\n";
+        f << "        \"p50\": " << Percentile(sorted, 0.50) << ",\n";
+        f << "        \"p95\": " << Percentile(sorted, 0.95) << ",\n";
+        f << "        \"p99\": " << Percentile(sorted, 0.99) << "\n";
+        f << "      },\n";
+        std::vector<double> update = r.updateMs;
+        std::sort(update.begin(), update.end());
+        double updateSum = 0.0;
+        for (double ms : update) updateSum += ms;
+        f << "      \"updateMs\": {\n";
+        f << "        \"mean\": " << updateSum / n << ",\n";
+        f << "        \"p95\": " << Percentile(update, 0.95) << ",\n";
+        f << "        \"max\": " << (update.empty() ? 0.0 : update.back()) << "\n";
+        f << "      },\n";
+        f << "      \"collisionQueriesPerFrame\": " << r.collisionQueries / n << ",\n";
+        f << "      \"drawCallsPerFrame\": " << r.drawCalls / n << ",\n";
+        f << "      \"trianglesPerFrame\": " << r.triangles / n << "\n";
+        f << "    }" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+
+    f << "  ]\n";
+    f << "}\n";
+
+    std::cout << "INFO::BENCHMARK::REPORT_WRITTEN: " << path << std::endl;
+    return true;
+}
+
+// Collision kernel microbenchmark
+
+static double CollisionNowMs() {
+    using namespace std::chrono;
+    return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+}
+
+int RunCollisionBenchmark(const BenchmarkOptions& options) {
+    const int boxCounts[] = { 256, 1024, 4096, 16384 };
+    const int queries = 2048;
+    const int repeats = std::max(1, options.frames / 100);
+
+    // Deterministic car-sized boxes scattered over a 200 x 200 area
+    uint32_t seed = 12345;
+    auto random01 = [&]() {
+        seed = seed * 1664525u + 1013904223u;
+        return (float)(seed >> 8) / (float)(1u << 24);
+    };
+    auto randomBox = [&]() {
+        glm::vec3 center(random01() * 200.0f - 100.0f, random01() * 4.0f, random01() * 200.0f - 100.0f);
+        glm::vec3 half(0.5f + random01() * 2.0f, 0.5f + random01(), 0.5f + random01() * 2.0f);
+        return AABB{ center - half, center + half };
+    };
+
+    std::ofstream f(options.outputPath);
+    if (!f.is_open()) {
+        std::cout << "ERROR::BENCHMARK::CANNOT_WRITE_REPORT: " << options.outputPath << std::endl;
+        return -1;
+    }
+
+    SimdLevel best = DetectSimdLevel();
+    std::cout << "INFO::BENCHMARK::COLLISION_KERNEL: " << SimdLevelName(best) << std::endl;
+    f << "{\n  \"detectedKernel\": \"" << SimdLevelName(best) << "\",\n  \"runs\": [\n";
+
+    for (size_t c = 0; c < std::size(boxCounts); c++) {
+        int n = boxCounts[c];
+        std::vector<AABB> boxes;
+        AABBSoA soa;
+        for (int i = 0; i < n; i++) {
+            boxes.push_back(randomBox());
+            soa.Add(boxes.back());
+        }
+        std::vector<AABB> queryBoxes;
+        for (int i = 0; i < queries; i++) queryBoxes.push_back(randomBox());
+        std::vector<uint8_t> masks(soa.BlockCount());
+
+        // Every kernel must count the same hits, or the timing is meaningless
+        auto timeRun = [&](auto&& queryFn, long long& hits) {
+            double start = CollisionNowMs();
+            for (int r = 0; r < repeats; r++) {
+                hits = 0;
+                for (const AABB& q : queryBoxes) hits += queryFn(q);
+            }
+            return (CollisionNowMs() - start) * 1.0e6 / ((double)repeats * queries * n);
+        };
+
+        long long scalarHits = 0;
+        double scalarNs = timeRun([&](const AABB& q) {
+            int hits = 0;
+            for (const AABB& b : boxes)
+                if (q.Overlaps(b)) hits++;
+            return hits;
+        }, scalarHits);
+
+        f << "    { \"boxes\": " << n << ", \"hits\": " << scalarHits
+          << ", \"nsPerTest\": { \"aosScalar\": " << scalarNs;
+        std::cout << "INFO::BENCHMARK::COLLISION " << n << " boxes: AoS scalar " << scalarNs << " ns/test";
+
+        SimdLevel levels[] = { SimdLevel::Scalar, SimdLevel::SSE, SimdLevel::AVX2 };
+        for (SimdLevel level : levels) {
+            if ((int)level > (int)best) continue;
+            long long hits = 0;
+            double ns = timeRun([&](const AABB& q) {
+                soa.OverlapMasks(q, masks.data(), level);
+                int count = 0;
+                for (uint8_t m : masks) count += std::popcount(m);
+                return count;
+            }, hits);
+
+            if (hits != scalarHits)
+                std::cout << std::endl << "ERROR::BENCHMARK::COLLISION_KERNEL_MISMATCH: "
+                          << SimdLevelName(level) << std::endl;
+            f << ", \"soa" << SimdLevelName(level) << "\": " << ns;
+            std::cout << ", SoA " << SimdLevelName(level) << " " << ns;
+        }
+        f << " } }" << (c + 1 < std::size(boxCounts) ? "," : "") << "\n";
+        std::cout << std::endl;
+    }
+
+    // Rotated props: SAT on every pair, SAT behind a bounds check, and the SoA kernels
+    // (bounds pre-filter plus batched SAT) at each level
+    auto randomProp = [&]() {
+        ObjectInstance obj;
+        obj.position = glm::vec3(random01() * 200.0f - 100.0f, random01() * 4.0f, random01() * 200.0f - 100.0f);
+        obj.scale = glm::vec3(0.5f + random01() * 4.0f, 1.0f + random01() * 2.0f, 0.5f + random01() * 4.0f);
+        obj.textureID = 0;
+        obj.rotation = glm::vec3((random01() - 0.5f) * 1.5f, random01() * 6.2831853f, (random01() - 0.5f) * 1.5f);
+        return OBBFromObject(obj);
+    };
+
+    f << "  ],\n  \"obbRuns\": [\n";
+    for (size_t c = 0; c < std::size(boxCounts); c++) {
+        int n = boxCounts[c];
+        std::vector<OBB> boxes;
+        std::vector<AABB> bounds;
+        OBBSoA soa;
+        for (int i = 0; i < n; i++) {
+            boxes.push_back(randomProp());
+            bounds.push_back(boxes.back().Bounds());
+            soa.Add(boxes.back());
+        }
+        std::vector<OBB> queryBoxes;
+        for (int i = 0; i < queries; i++) queryBoxes.push_back(randomProp());
+        std::vector<uint8_t> masks(soa.BlockCount());
+
+        auto timeRun = [&](auto&& queryFn, long long& hits) {
+            double start = CollisionNowMs();
+            for (int r = 0; r < repeats; r++) {
+                hits = 0;
+                for (const OBB& q : queryBoxes) hits += queryFn(q);
+            }
+            return (CollisionNowMs() - start) * 1.0e6 / ((double)repeats * queries * n);
+        };
+
+        long long satHits = 0;
+        double satNs = timeRun([&](const OBB& q) {
+            int hits = 0;
+            for (const OBB& b : boxes)
+                if (OBBOverlaps(q, b)) hits++;
+            return hits;
+        }, satHits);
+
+        long long filteredHits = 0;
+        double filteredNs = timeRun([&](const OBB& q) {
+            AABB qBounds = q.Bounds();
+            int hits = 0;
+            for (int i = 0; i < n; i++)
+                if (qBounds.Overlaps(bounds[i]) && OBBOverlaps(q, boxes[i])) hits++;
+            return hits;
+        }, filteredHits);
+
+        if (filteredHits != satHits)
+            std::cout << "ERROR::BENCHMARK::OBB_PREFILTER_MISMATCH" << std::endl;
+        f << "    { \"boxes\": " << n << ", \"hits\": " << satHits
+          << ", \"nsPerTest\": { \"aosSat\": " << satNs << ", \"aosPrefiltered\": " << filteredNs;
+        std::cout << "INFO::BENCHMARK::OBB " << n << " boxes: AoS SAT " << satNs
+                  << " ns/test, AoS pre-filtered " << filteredNs;
+
+        SimdLevel levels[] = { SimdLevel::Scalar, SimdLevel::SSE, SimdLevel::AVX2 };
+        for (SimdLevel level : levels) {
+            if ((int)level > (int)best) continue;
+            long long hits = 0;
+            double ns = timeRun([&](const OBB& q) {
+                soa.OverlapMasks(q, masks.data(), level);
+                int count = 0;
+                for (uint8_t m : masks) count += std::popcount(m);
+                return count;
+            }, hits);
+
+            if (hits != satHits)
+                std::cout << std::endl << "ERROR::BENCHMARK::OBB_KERNEL_MISMATCH: "
+                          << SimdLevelName(level) << std::endl;
+            f << ", \"soa" << SimdLevelName(level) << "\": " << ns;
+            std::cout << ", SoA " << SimdLevelName(level) << " " << ns;
+        }
+        f << " } }" << (c + 1 < std::size(boxCounts) ? "," : "") << "\n";
+        std::cout << std::endl;
+    }
+
+    f << "  ]\n}\n";
+    std::cout << "INFO::BENCHMARK::REPORT_WRITTEN: " << options.outputPath << std::endl;
+    return 0;
+}
+
+// Noise generator microbenchmark
+
+int RunNoiseBenchmark(const BenchmarkOptions& options) {
+    const int side = 512;
+    const int samples = side * side;
+    const int repeats = std::max(1, options.frames / 100);
+
+    // One terrain-sized grid of sample positions, away from the origin so negative cells are covered
+    std::vector<float> xs(samples), zs(samples), reference(samples), out(samples);
+    for (int z = 0; z < side; z++) {
+        for (int x = 0; x < side; x++) {
+            xs[(size_t)z * side + x] = (float)(x - side / 2) * 1.5f + 10000.0f;
+            zs[(size_t)z * side + x] = (float)(z - side / 2) * 1.5f - 3000.0f;
+        }
+    }
+
+    std::ofstream f(options.outputPath);
+    if (!f.is_open()) {
+        std::cout << "ERROR::BENCHMARK::CANNOT_WRITE_REPORT: " << options.outputPath << std::endl;
+        return -1;
+    }
+
+    SimdLevel best = DetectSimdLevel();
+    std::cout << "INFO::BENCHMARK::NOISE_KERNEL: " << SimdLevelName(best) << std::endl;
+    f << "{\n  \"detectedKernel\": \"" << SimdLevelName(best) << "\",\n  \"samples\": " << samples
+      << ",\n  \"runs\": [\n";
+
+    // Returns samples per second
+    auto timeRun = [&](auto&& sampleFn) {
+        double start = CollisionNowMs();
+        for (int r = 0; r < repeats; r++) sampleFn();
+        return (double)repeats * samples / ((CollisionNowMs() - start) * 1.0e-3);
+    };
+
+    const NoiseType types[] = { NoiseType::FBm, NoiseType::Ridged, NoiseType::DomainWarp };
+    const char* typeNames[] = { "fbm", "ridged", "domainWarp" };
+    for (size_t t = 0; t < std::size(types); t++) {
+        NoiseSettings settings;
+        settings.type = types[t];
+        NoiseGenerator noise(settings);
+        const TerrainGenerator* generator = &noise;
+
+        // Baseline: one virtual GetHeight per sample, as terrain sampling worked before batching
+        double pointRate = timeRun([&]() {
+            for (int i = 0; i < samples; i++) reference[i] = generator->GetHeight(xs[i], zs[i]);
+        });
+        f << "    { \"type\": \"" << typeNames[t] << "\", \"octaves\": " << settings.octaves
+          << ", \"samplesPerSec\": { \"pointVirtual\": " << pointRate;
+        std::cout << "INFO::BENCHMARK::NOISE " << typeNames[t] << ": per-point " << pointRate / 1.0e6 << " M/s";
+
+        SimdLevel levels[] = { SimdLevel::Scalar, SimdLevel::SSE, SimdLevel::AVX2 };
+        for (SimdLevel level : levels) {
+            if ((int)level > (int)best) continue;
+            double rate = timeRun([&]() { noise.GetHeights(xs.data(), zs.data(), samples, out.data(), level); });
+
+            // Every kernel must match the scalar heights bit for bit
+            if (std::memcmp(out.data(), reference.data(), samples * sizeof(float)) != 0)
+                std::cout << std::endl << "ERROR::BENCHMARK::NOISE_KERNEL_MISMATCH: "
+                          << SimdLevelName(level) << std::endl;
+            f << ", \"batch" << SimdLevelName(level) << "\": " << rate;
+            std::cout << ", batch " << SimdLevelName(level) << " " << rate / 1.0e6 << " M/s";
+        }
+        f << " } }" << (t + 1 < std::size(types) ? "," : "") << "\n";
+        std::cout << std::endl;
+    }
+
+    f << "  ]\n}\n";
+    std::cout << "INFO::BENCHMARK::REPORT_WRITTEN: " << options.outputPath << std::endl;
+    return 0;
+}
@@ -5,6 +5,14 @@
 #include "scenes/p4_scene.hpp"
 #include "scenes/p5_scene.hpp"
 #include "scenes/p6_scene.hpp"
+#include "scenes/p7_scene.hpp"
+#include "textures/texture_manager.hpp"
+#include "utils/profiler.hpp"
+#include "utils/render_stats.hpp"
+#include "utils/replay.hpp"
+#include "utils/time.hpp"
+#include <algorithm>
+#include <chrono>
 #include <iostream>
 
 // Called whenever the window or framebuffer's size is changed
@@ -42,11 +50,30 @@ void GameWindow::LoadContent() {
     sceneManager.RegisterScene(new P4Scene());
     sceneManager.RegisterScene(new P5Scene());
     sceneManager.RegisterScene(new P6Scene());
-    sceneManager.SwitchTo(0);
+    sceneManager.RegisterScene(new P7Scene());
+
+    // The benchmark loads each scene itself so it can time the load
+    if (benchmark.enabled)
+        return;
+    if (benchmark.recordPath.empty()) {
+        sceneManager.SwitchTo(0);
+        return;
+    }
+    benchmark.scene = std::min(benchmark.scene, (int)sceneManager.scenes.size() - 1);
+    sceneManager.SwitchTo(benchmark.scene);
+    Replay::StartRecording(benchmark.scene, sceneManager.scenes[benchmark.scene]->seed);
 }
 
 void GameWindow::Update() {
+    {
+        PROFILE_SCOPE("Texture uploads");
+        TextureManager::ProcessUploads(TEXTURE_UPLOAD_BUDGET_MS);
+    }
     sceneManager.Update();
+
+    // A recording covers one scene from its load; switching tabs ends it
+    if (Replay::GetMode() == Replay::Mode::Recording && sceneManager.activeIndex != benchmark.scene)
+        Replay::StopRecording(benchmark.recordPath);
 }
 
 void GameWindow::Render() {
@@ -62,18 +89,164 @@ void GameWindow::Render() {
     // Tab bar and active scene
     sceneManager.RenderTabs();
     sceneManager.Render();
+    Profiler::RenderUI();
 
     // End ImGui frame
-    ImGui::Render();
-    ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+    {
+        PROFILE_SCOPE("ImGui");
+        ImGui::Render();
+        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+    }
 
     glfwSwapBuffers(this->windowHandle);
     glfwPollEvents();
 }
 
 void GameWindow::Unload() {
+    Replay::StopRecording(benchmark.recordPath);
     sceneManager.UnloadAll();
+    TextureManager::Shutdown();
+    Profiler::Shutdown();
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
     ImGui::DestroyContext();
 }
+
+static double ElapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void GameWindow::HeadlessFrame(SceneBenchmarkResult* r) {
+    Scene* scene = sceneManager.scenes[sceneManager.activeIndex];
+    RenderStats::Reset();
+    uint64_t queriesBefore = scene->CollisionQueries();
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    Update();
+    double updateMs = ElapsedMs(start);
+
+    // Same as Render() minus the tab bar, ImGui draw and swap, so only scene work is counted
+    ImGui_ImplOpenGL3_NewFrame();
+    ImGui_ImplGlfw_NewFrame();
+    ImGui::NewFrame();
+    glClearColor(0.1f, 0.1f, 0.1f, 1.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    sceneManager.Render();
+    ImGui::Render();
+    glFinish();
+
+    if (!r) return;
+    r->frameMs.push_back(ElapsedMs(start));
+    r->updateMs.push_back(updateMs);
+    r->collisionQueries += scene->CollisionQueries() - queriesBefore;
+    r->drawCalls += RenderStats::drawCalls;
+    r->triangles += RenderStats::triangles;
+}
+
+// Headless run: every registered scene is loaded, warmed up and timed for a fixed
+// number of frames at a fixed delta time. GPU work is included via glFinish.
+int GameWindow::RunBenchmark() {
+    using Clock = std::chrono::steady_clock;
+    if (!benchmark.replayPath.empty())
+        return RunReplay();
+
+    glfwSwapInterval(0);
+    RenderStats::Install();
+    // Every scene is timed from a cold load, so no speculative preloading
+    sceneManager.preloadNeighbours = false;
+    Time::fixedDeltaTime = benchmark.deltaTime;
+
+    const char* rendererStr = (const char*)glGetString(GL_RENDERER);
+    std::string renderer = rendererStr ? rendererStr : "unknown";
+    std::cout << "INFO::BENCHMARK::RENDERER: " << renderer << std::endl;
+
+    std::vector<SceneBenchmarkResult> results;
+    for (int i = 0; i < (int)sceneManager.scenes.size(); i++) {
+        SceneBenchmarkResult r;
+        r.name = sceneManager.scenes[i]->name;
+
+        Clock::time_point start = Clock::now();
+        sceneManager.SwitchTo(i);
+        // Measure the full load, not just the part before textures stream in
+        TextureManager::FinishPending();
+        glFinish();
+        r.loadMs = ElapsedMs(start);
+
+        r.frameMs.reserve(benchmark.frames);
+        r.updateMs.reserve(benchmark.frames);
+        for (int f = 0; f < benchmark.warmupFrames + benchmark.frames; f++)
+            HeadlessFrame(f < benchmark.warmupFrames ? nullptr : &r);
+
+        start = Clock::now();
+        sceneManager.UnloadAll();
+        glFinish();
+        r.unloadMs = ElapsedMs(start);
+
+        std::cout << "INFO::BENCHMARK::SCENE(" << r.name << ")::LOAD " << r.loadMs << " ms" << std::endl;
+        results.push_back(r);
+    }
+
+    Time::fixedDeltaTime = 0.0f;
+    return WriteBenchmarkReport(benchmark.outputPath, benchmark, renderer, results) ? 0 : -1;
+}
+
+// Headless replay: loads the recorded scene with the recorded seed, feeds every recorded
+// frame back through it and checks the state hash after each simulation step. Timings are
+// written in the benchmark report format, so two builds can be compared on the same run.
+int GameWindow::RunReplay() {
+    using Clock = std::chrono::steady_clock;
+
+    Recording recording;
+    if (!recording.Load(benchmark.replayPath))
+        return -1;
+    if (recording.scene < 0 || recording.scene >= (int)sceneManager.scenes.size()) {
+        std::cout << "ERROR::REPLAY::UNKNOWN_SCENE: " << recording.scene << std::endl;
+        return -1;
+    }
+
+    glfwSwapInterval(0);
+    RenderStats::Install();
+    sceneManager.preloadNeighbours = false;
+
+    const char* rendererStr = (const char*)glGetString(GL_RENDERER);
+    std::string renderer = rendererStr ? rendererStr : "unknown";
+
+    Scene* scene = sceneManager.scenes[recording.scene];
+    scene->seed = recording.seed;
+    SceneBenchmarkResult r;
+    r.name = scene->name;
+
+    Clock::time_point start = Clock::now();
+    sceneManager.SwitchTo(recording.scene);
+    TextureManager::FinishPending();
+    glFinish();
+    r.loadMs = ElapsedMs(start);
+
+    Replay::StartPlayback(recording);
+    r.frameMs.reserve(recording.frames.size());
+    r.updateMs.reserve(recording.frames.size());
+    while (!Replay::PlaybackFinished())
+        HeadlessFrame(&r);
+    int steps = Replay::StepsChecked();
+    int mismatches = Replay::Mismatches();
+    int firstMismatch = Replay::FirstMismatch();
+    Replay::StopPlayback();
+
+    start = Clock::now();
+    sceneManager.UnloadAll();
+    glFinish();
+    r.unloadMs = ElapsedMs(start);
+
+    bool identical = mismatches == 0 && steps == (int)recording.stepHashes.size();
+    if (identical)
+        std::cout << "INFO::REPLAY::IDENTICAL " << steps << " steps" << std::endl;
+    else
+        std::cout << "ERROR::REPLAY::DIVERGED at step " << firstMismatch << ", " << mismatches << " of "
+                  << steps << " steps differ (" << recording.stepHashes.size() << " recorded)" << std::endl;
+
+    BenchmarkOptions options = benchmark;
+    options.frames = (int)recording.frames.size();
+    options.warmupFrames = 0;
+    bool written = WriteBenchmarkReport(benchmark.outputPath, options, renderer, { r });
+    return identical && written ? 0 : 1;
+}
@@ -0,0 +1,128 @@
+#include "ecs/avoidance.hpp"
+#include "utils/profiler.hpp"
+#include <atomic>
+#include <cfloat>
+#include <cmath>
+
+// Agents per parallel chunk
+static const int AVOIDANCE_GRAIN = 512;
+
+// One neighbour as seen by the agent choosing a velocity. For a candidate velocity v the
+// relative velocity is scale * v - base: scale 2 with base current + other's velocity when both
+// steer (the RVO apex), scale 1 with base the other's velocity when only this agent does.
+struct Obstacle {
+    glm::vec2 offset;   // other position - own position
+    glm::vec2 base;
+    float scale;
+    float gap;          // |offset|^2 - (r1 + r2)^2, negative while overlapping
+};
+
+// Time until the agent moving at v hits the obstacle; FLT_MAX if never.
+// Overlapping agents collide now unless already separating.
+static float TimeToCollision(const Obstacle& o, const glm::vec2& v) {
+    glm::vec2 relative = o.scale * v - o.base;
+    float b = glm::dot(o.offset, relative);
+    if (b <= 0.0f) return FLT_MAX;
+    if (o.gap < 0.0f) return 0.0f;
+
+    float a = glm::dot(relative, relative);
+    float disc = b * b - a * o.gap;
+    if (disc < 0.0f) return FLT_MAX;
+    return (b - std::sqrt(disc)) / a;
+}
+
+void AvoidanceSystem::TakeSnapshot(World& world) {
+    positions.clear();
+    velocities.clear();
+    radii.clear();
+    steers.clear();
+
+    world.EachColumns<Transform, Agent>([&](int count, const Entity* entities, Transform* t, Agent* a) {
+        for (int i = 0; i < count; i++) {
+            if (entities[i] >= snapshotIndex.size()) snapshotIndex.resize(entities[i] + 1, -1);
+            snapshotIndex[entities[i]] = (int)positions.size();
+            positions.push_back(t[i].pos);
+            velocities.push_back(glm::vec2(a[i].velocity.x, a[i].velocity.z));
+            radii.push_back(a[i].radius);
+            steers.push_back(0);
+        }
+    });
+    world.EachColumns<Agent, Velocity>([&](int count, const Entity* entities, Agent*, Velocity*) {
+        for (int i = 0; i < count; i++) steers[snapshotIndex[entities[i]]] = 1;
+    });
+
+    hash.Build(positions.data(), (int)positions.size());
+}
+
+void AvoidanceSystem::Step(World& world) {
+    PROFILE_SCOPE("Avoidance");
+    TakeSnapshot(world);
+
+    // Sample headings as offsets from the preferred one, so small swerves are tried first
+    static const auto offsets = [] {
+        std::vector<glm::vec2> dirs;
+        for (int k = 1; k < AVOIDANCE_SAMPLE_DIRECTIONS; k++) {
+            float angle = k * 2.0f * 3.14159265f / AVOIDANCE_SAMPLE_DIRECTIONS;
+            dirs.push_back(glm::vec2(std::cos(angle), std::sin(angle)));
+        }
+        return dirs;
+    }();
+
+    std::atomic<int> total{0};
+    world.ParallelColumns<Transform, Agent, Velocity>(AVOIDANCE_GRAIN,
+        [&](int count, const Entity* entities, Transform* t, Agent* a, Velocity* v) {
+            int neighbours[AVOIDANCE_MAX_NEIGHBOURS];
+            for (int i = 0; i < count; i++) {
+                int self = snapshotIndex[entities[i]];
+                glm::vec2 pos(t[i].pos.x, t[i].pos.z);
+                glm::vec2 preferred(v[i].linear.x, v[i].linear.z);
+                glm::vec2 current = velocities[self];
+                int n = hash.Nearest(t[i].pos, AVOIDANCE_NEIGHBOUR_DIST, AVOIDANCE_MAX_NEIGHBOURS, self, neighbours);
+
+                Obstacle obstacles[AVOIDANCE_MAX_NEIGHBOURS];
+                for (int j = 0; j < n; j++) {
+                    int o = neighbours[j];
+                    Obstacle& ob = obstacles[j];
+                    ob.offset = glm::vec2(positions[o].x - pos.x, positions[o].z - pos.y);
+                    ob.scale = steers[o] ? 2.0f : 1.0f;
+                    ob.base = steers[o] ? current + velocities[o] : velocities[o];
+                    float r = a[i].radius + radii[o];
+                    ob.gap = glm::dot(ob.offset, ob.offset) - r * r;
+                }
+
+                glm::vec2 best = preferred;
+                float bestPenalty = FLT_MAX;
+                // Returns false once a candidate is collision-free within the horizon
+                auto score = [&](const glm::vec2& candidate) {
+                    float penalty = glm::length(candidate - preferred);
+                    // The collision term only adds, so a candidate this far off can't win
+                    if (penalty >= bestPenalty) return true;
+                    float tc = FLT_MAX;
+                    for (int j = 0; j < n; j++)
+                        tc = std::min(tc, TimeToCollision(obstacles[j], candidate));
+                    if (tc < AVOIDANCE_TIME_HORIZON)
+                        penalty += AVOIDANCE_COLLISION_WEIGHT / std::max(tc, 0.001f);
+                    if (penalty < bestPenalty) {
+                        bestPenalty = penalty;
+                        best = candidate;
+                    }
+                    return tc < AVOIDANCE_TIME_HORIZON;
+                };
+
+                if (n > 0 && score(preferred)) {
+                    float speed = glm::length(preferred);
+                    glm::vec2 heading = speed > 0.0f ? preferred / speed : glm::vec2(1.0f, 0.0f);
+                    for (const glm::vec2& o : offsets) {
+                        glm::vec2 dir(heading.x * o.x - heading.y * o.y, heading.x * o.y + heading.y * o.x);
+                        score(dir * a[i].maxSpeed);
+                        score(dir * (a[i].maxSpeed * 0.5f));
+                    }
+                    score(preferred * 0.5f);
+                    score(glm::vec2(0.0f));
+                }
+                a[i].velocity = glm::vec3(best.x, 0.0f, best.y);
+            }
+            total += count;
+        });
+    queries = total;
+}
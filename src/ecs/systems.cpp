@@ -0,0 +1,74 @@
+#include "ecs/systems.hpp"
+#include "utils/interpolate.hpp"
+#include "utils/profiler.hpp"
+#include "utils/replay.hpp"
+#include <glm/gtc/matrix_transform.hpp>
+
+void StorePreviousTransforms(World& world) {
+    world.EachColumns<Transform>([](int count, const Entity*, Transform* t) {
+        for (int i = 0; i < count; i++) {
+            t[i].prevPos = t[i].pos;
+            t[i].prevYaw = t[i].yaw;
+        }
+    });
+}
+
+void FollowTracks(World& world, float dt) {
+    world.EachColumns<Transform, TrackFollower>([dt](int count, const Entity*, Transform* t, TrackFollower* f) {
+        for (int i = 0; i < count; i++)
+            AdvanceOnTrack(t[i], f[i], dt);
+    });
+}
+
+void SyncColliders(World& world, AABBTree& tree) {
+    PROFILE_SCOPE("ECS colliders");
+    world.EachColumns<Transform, Collider>([&](int count, const Entity*, Transform* t, Collider* c) {
+        for (int i = 0; i < count; i++) {
+            AABB box = AABBFromCar(t[i].pos, c[i].half);
+            if (c[i].proxy < 0)
+                c[i].proxy = tree.CreateProxy(box, c[i].tag);
+            else if (t[i].pos != t[i].prevPos)
+                tree.MoveProxy(c[i].proxy, box, t[i].pos - t[i].prevPos);
+        }
+    });
+}
+
+void ObserveVelocities(World& world, float dt) {
+    float invDt = dt > 0.0f ? 1.0f / dt : 0.0f;
+    world.EachColumns<Transform, Agent>([invDt](int count, const Entity*, Transform* t, Agent* a) {
+        for (int i = 0; i < count; i++)
+            a[i].velocity = (t[i].pos - t[i].prevPos) * invDt;
+    });
+}
+
+void SubmitInstances(World& world, float alpha, InstanceBatch& batch) {
+    PROFILE_SCOPE("ECS instances");
+    world.EachColumns<Transform, RenderMesh>([&](int count, const Entity*, Transform* t, RenderMesh* r) {
+        for (int i = 0; i < count; i++) {
+            glm::mat4 m = glm::translate(glm::mat4(1.0f), glm::mix(t[i].prevPos, t[i].pos, alpha));
+            if (t[i].yaw != 0.0f || t[i].prevYaw != 0.0f)
+                m = glm::rotate(m, glm::radians(LerpAngleDegrees(t[i].prevYaw, t[i].yaw, alpha)),
+                                glm::vec3(0, 1, 0));
+            m = glm::scale(m, r[i].scale);
+            m = glm::translate(m, glm::vec3(0, r[i].lift, 0));
+            batch.Add(m, r[i].texture);
+        }
+    });
+}
+
+template<typename C>
+static uint64_t HashColumn(const World& world, uint64_t hash) {
+    world.EachColumns<C>([&](int count, const Entity* entities, const C* c) {
+        hash = HashBytes(entities, count * sizeof(Entity), hash);
+        hash = HashBytes(c, count * sizeof(C), hash);
+    });
+    return hash;
+}
+
+uint64_t HashSimulationState(const World& world, uint64_t hash) {
+    hash = HashColumn<Transform>(world, hash);
+    hash = HashColumn<Velocity>(world, hash);
+    hash = HashColumn<TrackFollower>(world, hash);
+    hash = HashColumn<Agent>(world, hash);
+    return HashColumn<Collider>(world, hash);
+}
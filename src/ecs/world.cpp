@@ -0,0 +1,107 @@
+#include "ecs/world.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+
+static std::atomic<int> componentCount{0};
+static size_t componentSizes[ECS_MAX_COMPONENTS];
+
+int World::RegisterComponent(size_t size) {
+    int id = componentCount.fetch_add(1);
+    if (id >= ECS_MAX_COMPONENTS) {
+        std::cout << "ERROR::ECS::TOO_MANY_COMPONENT_TYPES" << std::endl;
+        std::abort();
+    }
+    componentSizes[id] = size;
+    return id;
+}
+
+size_t World::ComponentSize(int componentId) {
+    return componentSizes[componentId];
+}
+
+int World::FindOrCreateArchetype(ComponentMask mask) {
+    auto it = archetypeByMask.find(mask);
+    if (it != archetypeByMask.end()) return it->second;
+
+    Archetype a;
+    a.mask = mask;
+    for (int id = 0; id < ECS_MAX_COMPONENTS; id++) {
+        a.columnOf[id] = -1;
+        if (!(mask & (1u << id))) continue;
+        a.columnOf[id] = (int)a.columns.size();
+        a.columns.push_back({ id, ComponentSize(id), {} });
+    }
+
+    archetypes.push_back(std::move(a));
+    int index = (int)archetypes.size() - 1;
+    archetypeByMask[mask] = index;
+    return index;
+}
+
+Entity World::AllocateEntity() {
+    if (!freeEntities.empty()) {
+        Entity e = freeEntities.back();
+        freeEntities.pop_back();
+        return e;
+    }
+    records.push_back({ -1, 0 });
+    return (Entity)(records.size() - 1);
+}
+
+int World::PushRow(int archetype, Entity e) {
+    Archetype& a = archetypes[archetype];
+    int row = a.Count();
+    a.entities.push_back(e);
+    for (Column& c : a.columns)
+        c.data.resize(c.data.size() + c.stride);
+    records[e] = { archetype, row };
+    return row;
+}
+
+void World::RemoveRow(int archetype, int row) {
+    Archetype& a = archetypes[archetype];
+    int last = a.Count() - 1;
+    if (row != last) {
+        for (Column& c : a.columns)
+            std::memcpy(c.data.data() + c.stride * row, c.data.data() + c.stride * last, c.stride);
+        a.entities[row] = a.entities[last];
+        records[a.entities[row]].row = row;
+    }
+    a.entities.pop_back();
+    for (Column& c : a.columns)
+        c.data.resize(c.data.size() - c.stride);
+}
+
+void World::MoveToArchetype(Entity e, ComponentMask mask) {
+    Record from = records[e];
+    int to = FindOrCreateArchetype(mask);
+    if (to == from.archetype) return;
+
+    int row = PushRow(to, e);
+    Archetype& src = archetypes[from.archetype];
+    Archetype& dst = archetypes[to];
+    for (Column& c : dst.columns) {
+        if (src.columnOf[c.componentId] < 0) continue;
+        std::memcpy(c.data.data() + c.stride * row, src.At(c.componentId, from.row), c.stride);
+    }
+    RemoveRow(from.archetype, from.row);
+}
+
+void World::Destroy(Entity e) {
+    if (!Alive(e)) return;
+    RemoveRow(records[e].archetype, records[e].row);
+    records[e].archetype = -1;
+    freeEntities.push_back(e);
+}
+
+void World::Clear() {
+    archetypes.clear();
+    archetypeByMask.clear();
+    records.clear();
+    freeEntities.clear();
+}
+
+bool World::Alive(Entity e) const {
+    return e < records.size() && records[e].archetype >= 0;
+}
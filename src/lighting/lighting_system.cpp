@@ -1,7 +1,10 @@
 #include "lighting/lighting_system.hpp"
+#include "utils/profiler.hpp"
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
-#include <string>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
 #include <iostream>
 #include <cmath>
 
@@ -10,11 +13,23 @@ void LightingSystem::Load() {
 
     // Create sun shadow map
     CreateShadowFBO(sunShadowFBO, sunShadowMap);
+
+    // Shared light uniform buffer, filled lazily in ApplyToShader
+    glGenBuffers(1, &lightUBO);
+    glBindBuffer(GL_UNIFORM_BUFFER, lightUBO);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(LightBlockStd140), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    uploadedValid = false;
 }
 
 void LightingSystem::Unload() {
     shadowShader.Unload();
 
+    glDeleteBuffers(1, &lightUBO);
+    lightUBO = 0;
+    uploadedValid = false;
+    configuredShaders.clear();
+
     glDeleteFramebuffers(1, &sunShadowFBO);
     glDeleteTextures(1, &sunShadowMap);
     sunShadowFBO = sunShadowMap = 0;
@@ -34,6 +49,12 @@ void LightingSystem::Unload() {
     pointLights.clear();
 }
 
+size_t LightingSystem::MemoryBytes() const {
+    size_t shadowMap = (size_t)SHADOW_WIDTH * SHADOW_HEIGHT * 4;
+    size_t pointShadowMap = (size_t)POINT_SHADOW_WIDTH * POINT_SHADOW_HEIGHT * 4 * 6;
+    return shadowMap * (1 + spotShadowMaps.size()) + pointShadowMap * pointShadowCubemaps.size();
+}
+
 void LightingSystem::SetSun(const DirectionalLight& light) {
     sun = light;
 }
@@ -150,24 +171,30 @@ glm::mat4 LightingSystem::CalcSpotLightSpaceMatrix(const SpotLight& light) {
 }
 
 void LightingSystem::RenderShadowMaps(
-    std::function<void(unsigned int shaderID, const glm::mat4& lightMVP)> drawScene)
+    std::function<void(Shader& shader, const glm::mat4& lightMVP)> drawScene)
 {
+    PROFILE_SCOPE("Shadow maps");
     glUseProgram(shadowShader.programID);
     glViewport(0, 0, SHADOW_WIDTH, SHADOW_HEIGHT);
 
     // Sun shadow pass
-    sunLightSpaceMatrix = CalcSunLightSpaceMatrix();
-    glBindFramebuffer(GL_FRAMEBUFFER, sunShadowFBO);
-    glClear(GL_DEPTH_BUFFER_BIT);
-    drawScene(shadowShader.programID, sunLightSpaceMatrix);
-    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    {
+        PROFILE_SCOPE("Sun");
+        sunLightSpaceMatrix = CalcSunLightSpaceMatrix();
+        glBindFramebuffer(GL_FRAMEBUFFER, sunShadowFBO);
+        glClear(GL_DEPTH_BUFFER_BIT);
+        drawScene(shadowShader, sunLightSpaceMatrix);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    }
 
     // Spot light shadow passes
+    static const char* spotLabels[MAX_SPOT_LIGHTS] = { "Spot 0", "Spot 1", "Spot 2", "Spot 3" };
     for (int i = 0; i < (int)spotLights.size(); i++) {
+        PROFILE_SCOPE(spotLabels[i]);
         spotLightSpaceMatrices[i] = CalcSpotLightSpaceMatrix(spotLights[i]);
         glBindFramebuffer(GL_FRAMEBUFFER, spotShadowFBOs[i]);
         glClear(GL_DEPTH_BUFFER_BIT);
-        drawScene(shadowShader.programID, spotLightSpaceMatrices[i]);
+        drawScene(shadowShader, spotLightSpaceMatrices[i]);
         glBindFramebuffer(GL_FRAMEBUFFER, 0);
     }
 
@@ -185,6 +212,12 @@ void LightingSystem::RenderShadowMaps(
         { GL_TEXTURE_CUBE_MAP_NEGATIVE_Z, { 0, 0,-1}, {0,-1, 0} },
     };
 
+    static const char* faceLabels[MAX_POINT_SHADOW_LIGHTS][6] = {
+        { "Point 0 +X", "Point 0 -X", "Point 0 +Y", "Point 0 -Y", "Point 0 +Z", "Point 0 -Z" },
+        { "Point 1 +X", "Point 1 -X", "Point 1 +Y", "Point 1 -Y", "Point 1 +Z", "Point 1 -Z" },
+        { "Point 2 +X", "Point 2 -X", "Point 2 +Y", "Point 2 -Y", "Point 2 +Z", "Point 2 -Z" },
+    };
+
     int numPointShadows = (int)pointShadowFBOs.size();
     for (int i = 0; i < numPointShadows; i++) {
         // Recalculate far plane each frame so UI attenuation changes are picked up
@@ -195,13 +228,14 @@ void LightingSystem::RenderShadowMaps(
 
         glBindFramebuffer(GL_FRAMEBUFFER, pointShadowFBOs[i]);
         for (int f = 0; f < 6; f++) {
+            PROFILE_SCOPE(faceLabels[i][f]);
             glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT,
                                    faces[f].target, pointShadowCubemaps[i], 0);
             glClear(GL_DEPTH_BUFFER_BIT);
 
             glm::mat4 view = glm::lookAt(pos, pos + faces[f].dir, faces[f].up);
             glm::mat4 lightMVP = proj * view;
-            drawScene(shadowShader.programID, lightMVP);
+            drawScene(shadowShader, lightMVP);
         }
         glBindFramebuffer(GL_FRAMEBUFFER, 0);
     }
@@ -210,98 +244,111 @@ void LightingSystem::RenderShadowMaps(
     glViewport(0, 0, 800, 600);
 }
 
-void LightingSystem::ApplyToShader(unsigned int litShaderID, const glm::vec3& cameraPos) {
-    glUseProgram(litShaderID);
+void LightingSystem::ConfigureShader(Shader& litShader) {
+    // Block binding and sampler units never change for a linked program, so set them once
+    if (std::find(configuredShaders.begin(), configuredShaders.end(), litShader.linkId) != configuredShaders.end())
+        return;
+
+    unsigned int blockIndex = glGetUniformBlockIndex(litShader.programID, "Lights");
+    if (blockIndex != GL_INVALID_INDEX)
+        glUniformBlockBinding(litShader.programID, blockIndex, LIGHT_BLOCK_BINDING);
+
+    litShader.SetInt("uSunShadowMap", 1);
+    for (int i = 0; i < MAX_SPOT_LIGHTS; i++)
+        litShader.SetInt("uSpotShadowMap", i, 2 + i);
+    // Always assign cubemap samplers to units 6-8 to avoid sampler type conflict on unit 0
+    for (int i = 0; i < MAX_POINT_SHADOW_LIGHTS; i++)
+        litShader.SetInt("uPointShadowMap", i, 6 + i);
+
+    configuredShaders.push_back(litShader.linkId);
+}
+
+void LightingSystem::PackLightBlock(LightBlockStd140& block) {
+    std::memset(static_cast<void*>(&block), 0, sizeof(block));
 
-    // Camera position
-    glUniform3fv(glGetUniformLocation(litShaderID, "uViewPos"), 1, glm::value_ptr(cameraPos));
+    block.sunDirection = glm::vec4(sun.direction, sun.intensity);
+    block.sunColor = glm::vec4(sun.color, 0.0f);
+    block.ambientColor = glm::vec4(ambientColor, 0.0f);
+    block.shadowParams = glm::vec4(POINT_SHADOW_NEAR, 0.0f, 0.0f, 0.0f);
+    block.lightCounts[0] = (int)spotLights.size();
+    block.lightCounts[1] = (int)pointLights.size();
+    block.lightCounts[2] = (int)pointShadowFBOs.size();
+    block.sunLightSpaceMVP = sunLightSpaceMatrix;
 
-    // Ambient
-    glUniform3fv(glGetUniformLocation(litShaderID, "uAmbientColor"), 1, glm::value_ptr(ambientColor));
+    for (int i = 0; i < (int)spotLights.size(); i++) {
+        const SpotLight& l = spotLights[i];
+        SpotLightStd140& dst = block.spots[i];
+        dst.position = glm::vec4(l.position, l.range);
+        dst.direction = glm::vec4(l.direction, l.intensity);
+        dst.color = glm::vec4(l.color, l.cutOff);
+        dst.cone = glm::vec4(l.outerCutOff, 0.0f, 0.0f, 0.0f);
+        dst.lightSpaceMVP = spotLightSpaceMatrices[i];
+    }
 
-    // Sun
-    glUniform3fv(glGetUniformLocation(litShaderID, "uSunDirection"), 1, glm::value_ptr(sun.direction));
-    glUniform3fv(glGetUniformLocation(litShaderID, "uSunColor"), 1, glm::value_ptr(sun.color));
-    glUniform1f(glGetUniformLocation(litShaderID, "uSunIntensity"), sun.intensity);
-    glUniformMatrix4fv(glGetUniformLocation(litShaderID, "uSunLightSpaceMVP"),
-                       1, GL_FALSE, glm::value_ptr(sunLightSpaceMatrix));
+    for (int i = 0; i < (int)pointLights.size(); i++) {
+        const PointLight& l = pointLights[i];
+        PointLightStd140& dst = block.points[i];
+        float farPlane = (i < (int)pointShadowFarPlanes.size()) ? pointShadowFarPlanes[i] : 0.0f;
+        dst.position = glm::vec4(l.position, l.intensity);
+        dst.color = glm::vec4(l.color, farPlane);
+        dst.attenuation = glm::vec4(l.constant, l.linear, l.quadratic, 0.0f);
+    }
+}
+
+void LightingSystem::UploadLightBlock() {
+    LightBlockStd140 block;
+    PackLightBlock(block);
+
+    // Diff per light against what the GPU already has and upload the union of dirty ranges
+    size_t dirtyBegin = sizeof(LightBlockStd140), dirtyEnd = 0;
+    auto markIfChanged = [&](size_t offset, size_t size) {
+        const char* now = reinterpret_cast<const char*>(&block) + offset;
+        const char* old = reinterpret_cast<const char*>(&uploadedBlock) + offset;
+        if (uploadedValid && std::memcmp(now, old, size) == 0) return;
+        dirtyBegin = std::min(dirtyBegin, offset);
+        dirtyEnd = std::max(dirtyEnd, offset + size);
+    };
+
+    markIfChanged(0, offsetof(LightBlockStd140, spots));
+    for (int i = 0; i < MAX_SPOT_LIGHTS; i++)
+        markIfChanged(offsetof(LightBlockStd140, spots) + i * sizeof(SpotLightStd140), sizeof(SpotLightStd140));
+    for (int i = 0; i < MAX_POINT_LIGHTS; i++)
+        markIfChanged(offsetof(LightBlockStd140, points) + i * sizeof(PointLightStd140), sizeof(PointLightStd140));
+
+    if (dirtyBegin >= dirtyEnd) return;
+
+    glBindBuffer(GL_UNIFORM_BUFFER, lightUBO);
+    glBufferSubData(GL_UNIFORM_BUFFER, dirtyBegin, dirtyEnd - dirtyBegin,
+                    reinterpret_cast<const char*>(&block) + dirtyBegin);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    uploadedBlock = block;
+    uploadedValid = true;
+}
+
+void LightingSystem::ApplyToShader(Shader& litShader, const glm::vec3& cameraPos) {
+    glUseProgram(litShader.programID);
+    ConfigureShader(litShader);
+
+    UploadLightBlock();
+    glBindBufferBase(GL_UNIFORM_BUFFER, LIGHT_BLOCK_BINDING, lightUBO);
+
+    // Camera position
+    litShader.SetVec3("uViewPos", cameraPos);
 
     // Bind sun shadow map to texture unit 1
     glActiveTexture(GL_TEXTURE1);
     glBindTexture(GL_TEXTURE_2D, sunShadowMap);
-    glUniform1i(glGetUniformLocation(litShaderID, "uSunShadowMap"), 1);
-
-    // Spot lights
-    int numSpots = (int)spotLights.size();
-    glUniform1i(glGetUniformLocation(litShaderID, "uNumSpotLights"), numSpots);
-
-    for (int i = 0; i < numSpots; i++) {
-        std::string idx = std::to_string(i);
-
-        glUniform3fv(glGetUniformLocation(litShaderID, ("uSpotPos[" + idx + "]").c_str()),
-                     1, glm::value_ptr(spotLights[i].position));
-        glUniform3fv(glGetUniformLocation(litShaderID, ("uSpotDir[" + idx + "]").c_str()),
-                     1, glm::value_ptr(spotLights[i].direction));
-        glUniform3fv(glGetUniformLocation(litShaderID, ("uSpotColor[" + idx + "]").c_str()),
-                     1, glm::value_ptr(spotLights[i].color));
-        glUniform1f(glGetUniformLocation(litShaderID, ("uSpotIntensity[" + idx + "]").c_str()),
-                    spotLights[i].intensity);
-        glUniform1f(glGetUniformLocation(litShaderID, ("uSpotCutOff[" + idx + "]").c_str()),
-                    spotLights[i].cutOff);
-        glUniform1f(glGetUniformLocation(litShaderID, ("uSpotOuterCutOff[" + idx + "]").c_str()),
-                    spotLights[i].outerCutOff);
-        glUniform1f(glGetUniformLocation(litShaderID, ("uSpotRange[" + idx + "]").c_str()),
-                    spotLights[i].range);
-
-        glUniformMatrix4fv(glGetUniformLocation(litShaderID,
-                           ("uSpotLightSpaceMVP[" + idx + "]").c_str()),
-                           1, GL_FALSE, glm::value_ptr(spotLightSpaceMatrices[i]));
-
-        // Bind spot shadow map to texture unit 2+i
+
+    // Bind spot shadow maps to texture units 2+i
+    for (int i = 0; i < (int)spotLights.size(); i++) {
         glActiveTexture(GL_TEXTURE2 + i);
         glBindTexture(GL_TEXTURE_2D, spotShadowMaps[i]);
-        glUniform1i(glGetUniformLocation(litShaderID,
-                    ("uSpotShadowMap[" + idx + "]").c_str()), 2 + i);
-    }
-
-    // Point lights
-    int numPoints = (int)pointLights.size();
-    glUniform1i(glGetUniformLocation(litShaderID, "uNumPointLights"), numPoints);
-
-    int numPointShadows = (int)pointShadowFBOs.size();
-    glUniform1i(glGetUniformLocation(litShaderID, "uNumPointShadowLights"), numPointShadows);
-    glUniform1f(glGetUniformLocation(litShaderID, "uPointShadowNear"), POINT_SHADOW_NEAR);
-
-    for (int i = 0; i < numPoints; i++) {
-        std::string idx = std::to_string(i);
-
-        glUniform3fv(glGetUniformLocation(litShaderID, ("uPointPos[" + idx + "]").c_str()),
-                     1, glm::value_ptr(pointLights[i].position));
-        glUniform3fv(glGetUniformLocation(litShaderID, ("uPointColor[" + idx + "]").c_str()),
-                     1, glm::value_ptr(pointLights[i].color));
-        glUniform1f(glGetUniformLocation(litShaderID, ("uPointIntensity[" + idx + "]").c_str()),
-                    pointLights[i].intensity);
-        glUniform1f(glGetUniformLocation(litShaderID, ("uPointConstant[" + idx + "]").c_str()),
-                    pointLights[i].constant);
-        glUniform1f(glGetUniformLocation(litShaderID, ("uPointLinear[" + idx + "]").c_str()),
-                    pointLights[i].linear);
-        glUniform1f(glGetUniformLocation(litShaderID, ("uPointQuadratic[" + idx + "]").c_str()),
-                    pointLights[i].quadratic);
     }
 
-    // Always assign cubemap samplers to units 6-8 to avoid sampler type conflict on unit 0
-    for (int i = 0; i < MAX_POINT_SHADOW_LIGHTS; i++) {
-        std::string idx = std::to_string(i);
-        glUniform1i(glGetUniformLocation(litShaderID,
-                    ("uPointShadowMap[" + idx + "]").c_str()), 6 + i);
-    }
-
-    // Bind actual point shadow cubemaps to texture units 6-8
-    for (int i = 0; i < numPointShadows; i++) {
-        std::string idx = std::to_string(i);
+    // Bind point shadow cubemaps to texture units 6-8
+    for (int i = 0; i < (int)pointShadowFBOs.size(); i++) {
         glActiveTexture(GL_TEXTURE6 + i);
         glBindTexture(GL_TEXTURE_CUBE_MAP, pointShadowCubemaps[i]);
-        glUniform1f(glGetUniformLocation(litShaderID,
-                    ("uPointFarPlane[" + idx + "]").c_str()), pointShadowFarPlanes[i]);
     }
 }
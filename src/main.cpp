@@ -1,7 +1,16 @@
 #include "display/game_window.hpp"
 
-int main() {
+int main(int argc, char** argv) {
     // Create the game window with the specified size and title
     GameWindow gw = GameWindow{ 800, 600, "graphics-processing-systems" };
+
+    // --benchmark runs every scene headless and writes a JSON report instead of opening a window
+    if (!ParseBenchmarkArgs(argc, argv, gw.benchmark))
+        return 1;
+    if (gw.benchmark.collisionKernels)
+        return RunCollisionBenchmark(gw.benchmark);
+    if (gw.benchmark.noiseKernels)
+        return RunNoiseBenchmark(gw.benchmark);
+
     return gw.Run();
-}
\ No newline at end of file
+}
@@ -0,0 +1,376 @@
+#include "scenes/noise_generator.hpp"
+#include <algorithm>
+#include <cmath>
+
+// Samples per GetGrid batch (x coordinates are expanded into a stack buffer)
+#define NOISE_GRID_CHUNK 256
+
+SimdLevel NoiseGenerator::level = DetectSimdLevel();
+
+namespace {
+
+// Lattice hash: the cell's coordinates times two large primes, xor'd with the seed, times an
+// odd constant. The gradient comes from the top three bits, which depend on every input bit.
+const uint32_t PRIME_X = 501125321u;
+const uint32_t PRIME_Z = 1136930381u;
+const uint32_t HASH_MUL = 0x27d4eb2du;
+
+// Seed offsets for the two displacement fields of the domain warp
+const uint32_t WARP_SEED_X = 0x9e3779b9u;
+const uint32_t WARP_SEED_Z = 0x7f4a7c15u;
+
+// Skew to and from the simplex grid
+const float F2 = 0.36602540378443864676f;   // (sqrt(3) - 1) / 2
+const float G2 = 0.21132486540518711775f;   // (3 - sqrt(3)) / 6
+const float G2X2M1 = -0.57735026918962576451f;  // 2 * G2 - 1
+// Brings the sum of the three corner contributions to about [-1, 1]
+const float SIMPLEX_SCALE = 45.0f;
+
+using NoiseKernel = void (*)(const NoiseLayers& l, const float* xs, const float* zs, int count, float* out);
+
+// Scalar kernel. Every SIMD kernel evaluates the same operations in the same order.
+
+int FloorToInt(float v) {
+    int i = (int)v;
+    return v < (float)i ? i - 1 : i;
+}
+
+// One of 8 gradients, (±1, ±2) or (±2, ±1), dotted with (x, y)
+float Grad(uint32_t hash, float x, float y) {
+    uint32_t g = hash >> 29;
+    float u = g < 4 ? x : y;
+    float v = g < 4 ? y : x;
+    return ((g & 1) ? -u : u) + ((g & 2) ? -(v + v) : v + v);
+}
+
+float Corner(float x, float y, uint32_t hash) {
+    float t = 0.5f - x * x - y * y;
+    t = t > 0.0f ? t : 0.0f;
+    t = t * t;
+    return t * t * Grad(hash, x, y);
+}
+
+float Simplex(float x, float y, uint32_t seed) {
+    float s = (x + y) * F2;
+    int i = FloorToInt(x + s);
+    int j = FloorToInt(y + s);
+    float t = (float)(i + j) * G2;
+    float x0 = x - ((float)i - t);
+    float y0 = y - ((float)j - t);
+
+    // Which of the cell's two triangles (x0, y0) lies in
+    bool upper = x0 > y0;
+    float x1 = (x0 - (upper ? 1.0f : 0.0f)) + G2;
+    float y1 = (y0 - (upper ? 0.0f : 1.0f)) + G2;
+    float x2 = x0 + G2X2M1;
+    float y2 = y0 + G2X2M1;
+
+    uint32_t xp = (uint32_t)i * PRIME_X;
+    uint32_t yp = (uint32_t)j * PRIME_Z;
+    float n0 = Corner(x0, y0, (seed ^ xp ^ yp) * HASH_MUL);
+    float n1 = Corner(x1, y1, (seed ^ (upper ? xp + PRIME_X : xp) ^ (upper ? yp : yp + PRIME_Z)) * HASH_MUL);
+    float n2 = Corner(x2, y2, (seed ^ (xp + PRIME_X) ^ (yp + PRIME_Z)) * HASH_MUL);
+    return SIMPLEX_SCALE * (n0 + n1 + n2);
+}
+
+float WarpScalar(const NoiseLayers& l, float x, float z, uint32_t seed) {
+    float sum = 0.0f;
+    for (int o = 0; o < NOISE_WARP_OCTAVES; o++)
+        sum = sum + Simplex(x * l.frequency[o], z * l.frequency[o], seed + (uint32_t)o) * l.warpAmplitude[o];
+    return sum;
+}
+
+float HeightScalar(const NoiseLayers& l, float x, float z) {
+    if (l.type == NoiseType::DomainWarp) {
+        float wx = WarpScalar(l, x, z, l.seed + WARP_SEED_X);
+        float wz = WarpScalar(l, x, z, l.seed + WARP_SEED_Z);
+        x = x + wx * l.warpStrength;
+        z = z + wz * l.warpStrength;
+    }
+
+    float sum = 0.0f;
+    for (int o = 0; o < l.octaves; o++) {
+        float n = Simplex(x * l.frequency[o], z * l.frequency[o], l.seed + (uint32_t)o);
+        if (l.type == NoiseType::Ridged) {
+            n = 1.0f - std::fabs(n);
+            n = n * n;
+        }
+        sum = sum + n * l.amplitude[o];
+    }
+    return sum + l.baseHeight;
+}
+
+void SampleScalar(const NoiseLayers& l, const float* xs, const float* zs, int count, float* out) {
+    for (int i = 0; i < count; i++)
+        out[i] = HeightScalar(l, xs[i], zs[i]);
+}
+
+#ifdef SIMD_X86
+
+// SSE2 has no 32-bit low multiply; build it from the two 32x32->64 lane products
+SIMD_TARGET("sse2")
+__m128i MulLoSSE(__m128i a, __m128i b) {
+    __m128i even = _mm_mul_epu32(a, b);
+    __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), _mm_srli_epi64(b, 32));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                              _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+// Truncate, then step down where that rounded up (negative non-integers)
+SIMD_TARGET("sse2")
+__m128i FloorToIntSSE(__m128 v) {
+    __m128i i = _mm_cvttps_epi32(v);
+    return _mm_add_epi32(i, _mm_castps_si128(_mm_cmplt_ps(v, _mm_cvtepi32_ps(i))));
+}
+
+SIMD_TARGET("sse2")
+__m128 GradSSE(__m128i hash, __m128 x, __m128 y) {
+    __m128i g = _mm_srli_epi32(hash, 29);
+    __m128 low = _mm_castsi128_ps(_mm_cmplt_epi32(g, _mm_set1_epi32(4)));
+    __m128 u = _mm_or_ps(_mm_and_ps(low, x), _mm_andnot_ps(low, y));
+    __m128 v = _mm_or_ps(_mm_and_ps(low, y), _mm_andnot_ps(low, x));
+    __m128 signU = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(g, _mm_set1_epi32(1)), 31));
+    __m128 signV = _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(g, _mm_set1_epi32(2)), 30));
+    return _mm_add_ps(_mm_xor_ps(u, signU), _mm_xor_ps(_mm_add_ps(v, v), signV));
+}
+
+SIMD_TARGET("sse2")
+__m128 CornerSSE(__m128 x, __m128 y, __m128i hash) {
+    __m128 t = _mm_sub_ps(_mm_sub_ps(_mm_set1_ps(0.5f), _mm_mul_ps(x, x)), _mm_mul_ps(y, y));
+    t = _mm_max_ps(t, _mm_setzero_ps());
+    t = _mm_mul_ps(t, t);
+    return _mm_mul_ps(_mm_mul_ps(t, t), GradSSE(hash, x, y));
+}
+
+SIMD_TARGET("sse2")
+__m128 SimplexSSE(__m128 x, __m128 y, __m128i seed) {
+    const __m128i primeX = _mm_set1_epi32((int)PRIME_X);
+    const __m128i primeZ = _mm_set1_epi32((int)PRIME_Z);
+    const __m128i hashMul = _mm_set1_epi32((int)HASH_MUL);
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 g2 = _mm_set1_ps(G2);
+
+    __m128 s = _mm_mul_ps(_mm_add_ps(x, y), _mm_set1_ps(F2));
+    __m128i i = FloorToIntSSE(_mm_add_ps(x, s));
+    __m128i j = FloorToIntSSE(_mm_add_ps(y, s));
+    __m128 t = _mm_mul_ps(_mm_cvtepi32_ps(_mm_add_epi32(i, j)), g2);
+    __m128 x0 = _mm_sub_ps(x, _mm_sub_ps(_mm_cvtepi32_ps(i), t));
+    __m128 y0 = _mm_sub_ps(y, _mm_sub_ps(_mm_cvtepi32_ps(j), t));
+
+    __m128 upper = _mm_cmpgt_ps(x0, y0);
+    __m128i upperI = _mm_castps_si128(upper);
+    __m128 x1 = _mm_add_ps(_mm_sub_ps(x0, _mm_and_ps(upper, one)), g2);
+    __m128 y1 = _mm_add_ps(_mm_sub_ps(y0, _mm_andnot_ps(upper, one)), g2);
+    __m128 x2 = _mm_add_ps(x0, _mm_set1_ps(G2X2M1));
+    __m128 y2 = _mm_add_ps(y0, _mm_set1_ps(G2X2M1));
+
+    __m128i xp = MulLoSSE(i, primeX);
+    __m128i yp = MulLoSSE(j, primeZ);
+    __m128i xp1 = _mm_add_epi32(xp, _mm_and_si128(upperI, primeX));
+    __m128i yp1 = _mm_add_epi32(yp, _mm_andnot_si128(upperI, primeZ));
+    __m128i h0 = MulLoSSE(_mm_xor_si128(_mm_xor_si128(seed, xp), yp), hashMul);
+    __m128i h1 = MulLoSSE(_mm_xor_si128(_mm_xor_si128(seed, xp1), yp1), hashMul);
+    __m128i h2 = MulLoSSE(_mm_xor_si128(_mm_xor_si128(seed, _mm_add_epi32(xp, primeX)), _mm_add_epi32(yp, primeZ)), hashMul);
+
+    __m128 n = _mm_add_ps(_mm_add_ps(CornerSSE(x0, y0, h0), CornerSSE(x1, y1, h1)), CornerSSE(x2, y2, h2));
+    return _mm_mul_ps(_mm_set1_ps(SIMPLEX_SCALE), n);
+}
+
+SIMD_TARGET("sse2")
+__m128 WarpSSE(const NoiseLayers& l, __m128 x, __m128 z, uint32_t seed) {
+    __m128 sum = _mm_setzero_ps();
+    for (int o = 0; o < NOISE_WARP_OCTAVES; o++) {
+        __m128 f = _mm_set1_ps(l.frequency[o]);
+        __m128 n = SimplexSSE(_mm_mul_ps(x, f), _mm_mul_ps(z, f), _mm_set1_epi32((int)(seed + (uint32_t)o)));
+        sum = _mm_add_ps(sum, _mm_mul_ps(n, _mm_set1_ps(l.warpAmplitude[o])));
+    }
+    return sum;
+}
+
+SIMD_TARGET("sse2")
+__m128 HeightSSE(const NoiseLayers& l, __m128 x, __m128 z) {
+    if (l.type == NoiseType::DomainWarp) {
+        __m128 strength = _mm_set1_ps(l.warpStrength);
+        __m128 wx = WarpSSE(l, x, z, l.seed + WARP_SEED_X);
+        __m128 wz = WarpSSE(l, x, z, l.seed + WARP_SEED_Z);
+        x = _mm_add_ps(x, _mm_mul_ps(wx, strength));
+        z = _mm_add_ps(z, _mm_mul_ps(wz, strength));
+    }
+
+    const __m128 signBit = _mm_set1_ps(-0.0f);
+    const __m128 one = _mm_set1_ps(1.0f);
+    __m128 sum = _mm_setzero_ps();
+    for (int o = 0; o < l.octaves; o++) {
+        __m128 f = _mm_set1_ps(l.frequency[o]);
+        __m128 n = SimplexSSE(_mm_mul_ps(x, f), _mm_mul_ps(z, f), _mm_set1_epi32((int)(l.seed + (uint32_t)o)));
+        if (l.type == NoiseType::Ridged) {
+            n = _mm_sub_ps(one, _mm_andnot_ps(signBit, n));
+            n = _mm_mul_ps(n, n);
+        }
+        sum = _mm_add_ps(sum, _mm_mul_ps(n, _mm_set1_ps(l.amplitude[o])));
+    }
+    return _mm_add_ps(sum, _mm_set1_ps(l.baseHeight));
+}
+
+SIMD_TARGET("sse2")
+void SampleSSE(const NoiseLayers& l, const float* xs, const float* zs, int count, float* out) {
+    int i = 0;
+    for (; i + 4 <= count; i += 4)
+        _mm_storeu_ps(out + i, HeightSSE(l, _mm_loadu_ps(xs + i), _mm_loadu_ps(zs + i)));
+    SampleScalar(l, xs + i, zs + i, count - i, out + i);
+}
+
+SIMD_TARGET("avx2")
+__m256 GradAVX2(__m256i hash, __m256 x, __m256 y) {
+    __m256i g = _mm256_srli_epi32(hash, 29);
+    __m256 low = _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(4), g));
+    __m256 u = _mm256_blendv_ps(y, x, low);
+    __m256 v = _mm256_blendv_ps(x, y, low);
+    __m256 signU = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(g, _mm256_set1_epi32(1)), 31));
+    __m256 signV = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_and_si256(g, _mm256_set1_epi32(2)), 30));
+    return _mm256_add_ps(_mm256_xor_ps(u, signU), _mm256_xor_ps(_mm256_add_ps(v, v), signV));
+}
+
+SIMD_TARGET("avx2")
+__m256 CornerAVX2(__m256 x, __m256 y, __m256i hash) {
+    __m256 t = _mm256_sub_ps(_mm256_sub_ps(_mm256_set1_ps(0.5f), _mm256_mul_ps(x, x)), _mm256_mul_ps(y, y));
+    t = _mm256_max_ps(t, _mm256_setzero_ps());
+    t = _mm256_mul_ps(t, t);
+    return _mm256_mul_ps(_mm256_mul_ps(t, t), GradAVX2(hash, x, y));
+}
+
+SIMD_TARGET("avx2")
+__m256 SimplexAVX2(__m256 x, __m256 y, __m256i seed) {
+    const __m256i primeX = _mm256_set1_epi32((int)PRIME_X);
+    const __m256i primeZ = _mm256_set1_epi32((int)PRIME_Z);
+    const __m256i hashMul = _mm256_set1_epi32((int)HASH_MUL);
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 g2 = _mm256_set1_ps(G2);
+
+    __m256 s = _mm256_mul_ps(_mm256_add_ps(x, y), _mm256_set1_ps(F2));
+    __m256i i = _mm256_cvttps_epi32(_mm256_floor_ps(_mm256_add_ps(x, s)));
+    __m256i j = _mm256_cvttps_epi32(_mm256_floor_ps(_mm256_add_ps(y, s)));
+    __m256 t = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_add_epi32(i, j)), g2);
+    __m256 x0 = _mm256_sub_ps(x, _mm256_sub_ps(_mm256_cvtepi32_ps(i), t));
+    __m256 y0 = _mm256_sub_ps(y, _mm256_sub_ps(_mm256_cvtepi32_ps(j), t));
+
+    __m256 upper = _mm256_cmp_ps(x0, y0, _CMP_GT_OQ);
+    __m256i upperI = _mm256_castps_si256(upper);
+    __m256 x1 = _mm256_add_ps(_mm256_sub_ps(x0, _mm256_and_ps(upper, one)), g2);
+    __m256 y1 = _mm256_add_ps(_mm256_sub_ps(y0, _mm256_andnot_ps(upper, one)), g2);
+    __m256 x2 = _mm256_add_ps(x0, _mm256_set1_ps(G2X2M1));
+    __m256 y2 = _mm256_add_ps(y0, _mm256_set1_ps(G2X2M1));
+
+    __m256i xp = _mm256_mullo_epi32(i, primeX);
+    __m256i yp = _mm256_mullo_epi32(j, primeZ);
+    __m256i xp1 = _mm256_add_epi32(xp, _mm256_and_si256(upperI, primeX));
+    __m256i yp1 = _mm256_add_epi32(yp, _mm256_andnot_si256(upperI, primeZ));
+    __m256i h0 = _mm256_mullo_epi32(_mm256_xor_si256(_mm256_xor_si256(seed, xp), yp), hashMul);
+    __m256i h1 = _mm256_mullo_epi32(_mm256_xor_si256(_mm256_xor_si256(seed, xp1), yp1), hashMul);
+    __m256i h2 = _mm256_mullo_epi32(_mm256_xor_si256(_mm256_xor_si256(seed, _mm256_add_epi32(xp, primeX)),
+                                                     _mm256_add_epi32(yp, primeZ)), hashMul);
+
+    __m256 n = _mm256_add_ps(_mm256_add_ps(CornerAVX2(x0, y0, h0), CornerAVX2(x1, y1, h1)), CornerAVX2(x2, y2, h2));
+    return _mm256_mul_ps(_mm256_set1_ps(SIMPLEX_SCALE), n);
+}
+
+SIMD_TARGET("avx2")
+__m256 WarpAVX2(const NoiseLayers& l, __m256 x, __m256 z, uint32_t seed) {
+    __m256 sum = _mm256_setzero_ps();
+    for (int o = 0; o < NOISE_WARP_OCTAVES; o++) {
+        __m256 f = _mm256_set1_ps(l.frequency[o]);
+        __m256 n = SimplexAVX2(_mm256_mul_ps(x, f), _mm256_mul_ps(z, f), _mm256_set1_epi32((int)(seed + (uint32_t)o)));
+        sum = _mm256_add_ps(sum, _mm256_mul_ps(n, _mm256_set1_ps(l.warpAmplitude[o])));
+    }
+    return sum;
+}
+
+SIMD_TARGET("avx2")
+__m256 HeightAVX2(const NoiseLayers& l, __m256 x, __m256 z) {
+    if (l.type == NoiseType::DomainWarp) {
+        __m256 strength = _mm256_set1_ps(l.warpStrength);
+        __m256 wx = WarpAVX2(l, x, z, l.seed + WARP_SEED_X);
+        __m256 wz = WarpAVX2(l, x, z, l.seed + WARP_SEED_Z);
+        x = _mm256_add_ps(x, _mm256_mul_ps(wx, strength));
+        z = _mm256_add_ps(z, _mm256_mul_ps(wz, strength));
+    }
+
+    const __m256 signBit = _mm256_set1_ps(-0.0f);
+    const __m256 one = _mm256_set1_ps(1.0f);
+    __m256 sum = _mm256_setzero_ps();
+    for (int o = 0; o < l.octaves; o++) {
+        __m256 f = _mm256_set1_ps(l.frequency[o]);
+        __m256 n = SimplexAVX2(_mm256_mul_ps(x, f), _mm256_mul_ps(z, f), _mm256_set1_epi32((int)(l.seed + (uint32_t)o)));
+        if (l.type == NoiseType::Ridged) {
+            n = _mm256_sub_ps(one, _mm256_andnot_ps(signBit, n));
+            n = _mm256_mul_ps(n, n);
+        }
+        sum = _mm256_add_ps(sum, _mm256_mul_ps(n, _mm256_set1_ps(l.amplitude[o])));
+    }
+    return _mm256_add_ps(sum, _mm256_set1_ps(l.baseHeight));
+}
+
+SIMD_TARGET("avx2")
+void SampleAVX2(const NoiseLayers& l, const float* xs, const float* zs, int count, float* out) {
+    int i = 0;
+    for (; i + 8 <= count; i += 8)
+        _mm256_storeu_ps(out + i, HeightAVX2(l, _mm256_loadu_ps(xs + i), _mm256_loadu_ps(zs + i)));
+    SampleSSE(l, xs + i, zs + i, count - i, out + i);
+}
+
+#endif
+
+NoiseKernel KernelFor(SimdLevel kernelLevel) {
+#ifdef SIMD_X86
+    if (kernelLevel == SimdLevel::AVX2) return SampleAVX2;
+    if (kernelLevel == SimdLevel::SSE) return SampleSSE;
+#endif
+    return SampleScalar;
+}
+
+}
+
+NoiseGenerator::NoiseGenerator(const NoiseSettings& noiseSettings) : settings(noiseSettings) {
+    layers.type = settings.type;
+    layers.seed = settings.seed;
+    layers.octaves = std::clamp(settings.octaves, 1, NOISE_MAX_OCTAVES);
+    layers.warpStrength = settings.warpStrength;
+    layers.baseHeight = settings.baseHeight;
+
+    float frequency = settings.frequency, amplitude = settings.amplitude, warpAmplitude = 1.0f;
+    for (int o = 0; o < NOISE_MAX_OCTAVES; o++) {
+        layers.frequency[o] = frequency;
+        layers.amplitude[o] = amplitude;
+        if (o < NOISE_WARP_OCTAVES) layers.warpAmplitude[o] = warpAmplitude;
+        frequency *= settings.lacunarity;
+        amplitude *= settings.gain;
+        warpAmplitude *= settings.gain;
+    }
+}
+
+float NoiseGenerator::GetHeight(float x, float z) const {
+    return HeightScalar(layers, x, z);
+}
+
+void NoiseGenerator::GetHeights(const float* xs, const float* zs, int count, float* out) const {
+    KernelFor(level)(layers, xs, zs, count, out);
+}
+
+void NoiseGenerator::GetHeights(const float* xs, const float* zs, int count, float* out, SimdLevel kernelLevel) const {
+    KernelFor(kernelLevel)(layers, xs, zs, count, out);
+}
+
+void NoiseGenerator::GetGrid(float x0, float z0, float spacing, int width, int height, float* out) const {
+    NoiseKernel kernel = KernelFor(level);
+    float xs[NOISE_GRID_CHUNK], zs[NOISE_GRID_CHUNK];
+    for (int row = 0; row < height; row++) {
+        float z = z0 + (float)row * spacing;
+        std::fill(zs, zs + NOISE_GRID_CHUNK, z);
+        for (int begin = 0; begin < width; begin += NOISE_GRID_CHUNK) {
+            int count = std::min(NOISE_GRID_CHUNK, width - begin);
+            for (int col = 0; col < count; col++)
+                xs[col] = x0 + (float)(begin + col) * spacing;
+            kernel(layers, xs, zs, count, out + (size_t)row * width + begin);
+        }
+    }
+}
@@ -81,8 +81,7 @@ void P1Scene::OnRender(const glm::mat4& view, const glm::mat4& projection) {
     glm::mat4 mvp = projection * view * model;
 
     glUseProgram(shader.programID);
-    int mvpLoc = glGetUniformLocation(shader.programID, "uMVP");
-    glUniformMatrix4fv(mvpLoc, 1, GL_FALSE, glm::value_ptr(mvp));
+    shader.SetMat4("uMVP", mvp);
 
     glBindVertexArray(VAO);
     glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
@@ -1,4 +1,5 @@
 #include "scenes/p2_scene.hpp"
+#include "textures/texture_manager.hpp"
 #include <cmath>
 
 #ifndef PI
@@ -9,13 +10,30 @@ void P2Scene::OnLoad() {
     road.Load();
     objectRenderer.Load();
     SetupObjects();
+    objectTransforms.Build(objects);
+    objectBatch.Add(objects, objectTransforms);
+    objectBatch.Upload();
+}
+
+void P2Scene::LoadTextures() {
+    if (!loadedTextures.empty()) return;  // already requested by OnPreload
+    loadedTextures.push_back(TextureManager::Load2D("resources/textures/objects/building.jpg"));
+    loadedTextures.push_back(TextureManager::Load2D("resources/textures/objects/tree_trunk.jpg"));
+}
+
+void P2Scene::OnPreload() {
+    LoadTextures();
+}
+
+void P2Scene::OnCancelPreload() {
+    for (auto tex : loadedTextures) TextureManager::Release(tex);
+    loadedTextures.clear();
 }
 
 void P2Scene::SetupObjects() {
-    unsigned int brickTex = objectRenderer.LoadTexture("resources/textures/objects/building.jpg");
-    unsigned int woodTex  = objectRenderer.LoadTexture("resources/textures/objects/tree_trunk.jpg");
-    loadedTextures.push_back(brickTex);
-    loadedTextures.push_back(woodTex);
+    LoadTextures();
+    unsigned int brickTex = loadedTextures[0];
+    unsigned int woodTex  = loadedTextures[1];
 
     // 5 buildings every 72 degrees, 8 units outside the road
     for (int i = 0; i < 5; i++) {
@@ -47,16 +65,18 @@ void P2Scene::OnUpdate() {
 
 void P2Scene::OnRender(const glm::mat4& view, const glm::mat4& projection) {
     road.Render(view, projection);
-    objectRenderer.Render(objects, view, projection);
+    objectRenderer.Render(objectBatch, view, projection);
 }
 
 void P2Scene::OnUnload() {
     road.Unload();
     objectRenderer.Unload();
+    objectBatch.Unload();
+    objectTransforms.Clear();
 
-    // Delete textures (each only once)
+    // Hand textures back; the manager keeps them around for the next scene
     for (auto tex : loadedTextures) {
-        glDeleteTextures(1, &tex);
+        TextureManager::Release(tex);
     }
     loadedTextures.clear();
     objects.clear();
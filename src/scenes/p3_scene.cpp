@@ -1,4 +1,5 @@
 #include "scenes/p3_scene.hpp"
+#include "textures/texture_manager.hpp"
 #include "lighting/light.hpp"
 #include "glad.h"
 #include <glm/gtc/matrix_transform.hpp>
@@ -21,16 +22,32 @@ void P3Scene::OnLoad() {
     objectRenderer.Load();
     SetupObjects();
     SetupLights();
+    objectTransforms.Build(objects);
+    objectBatch.Add(objects, objectTransforms);
+    objectBatch.Upload();
 }
 
-void P3Scene::SetupObjects() {
-    unsigned int brickTex = objectRenderer.LoadTexture("resources/textures/objects/building.jpg");
-    unsigned int woodTex  = objectRenderer.LoadTexture("resources/textures/objects/tree_trunk.jpg");
-    unsigned int steelTex = objectRenderer.LoadTexture("resources/textures/objects/steel.jpg");
+void P3Scene::LoadTextures() {
+    if (!loadedTextures.empty()) return;  // already requested by OnPreload
+    loadedTextures.push_back(TextureManager::Load2D("resources/textures/objects/building.jpg"));
+    loadedTextures.push_back(TextureManager::Load2D("resources/textures/objects/tree_trunk.jpg"));
+    loadedTextures.push_back(TextureManager::Load2D("resources/textures/objects/steel.jpg"));
+}
+
+void P3Scene::OnPreload() {
+    LoadTextures();
+}
+
+void P3Scene::OnCancelPreload() {
+    for (auto tex : loadedTextures) TextureManager::Release(tex);
+    loadedTextures.clear();
+}
 
-    loadedTextures.push_back(brickTex);
-    loadedTextures.push_back(woodTex);
-    loadedTextures.push_back(steelTex);
+void P3Scene::SetupObjects() {
+    LoadTextures();
+    unsigned int brickTex = loadedTextures[0];
+    unsigned int woodTex  = loadedTextures[1];
+    unsigned int steelTex = loadedTextures[2];
 
     // 5 buildings every 72 degrees, 8 units outside the road
     for (int i = 0; i < 5; i++) {
@@ -115,20 +132,17 @@ void P3Scene::SetupLights() {
     }
 }
 
-void P3Scene::OnRenderGeometry(unsigned int shaderID, const glm::mat4& lightMVP) {
-    int loc = glGetUniformLocation(shaderID, "uLightMVP");
+void P3Scene::OnRenderGeometry(Shader& shader, const glm::mat4& lightMVP) {
+    int loc = shader.GetUniformLocation("uLightMVP");
 
     // Road
     glm::mat4 roadMVP = lightMVP * glm::mat4(1.0f);
     glUniformMatrix4fv(loc, 1, GL_FALSE, glm::value_ptr(roadMVP));
     road.DrawGeometry();
 
-    // Objects
-    for (const auto& obj : objects) {
-        glm::mat4 model = ModelMatrixFromObject(obj);
-        glUniformMatrix4fv(loc, 1, GL_FALSE, glm::value_ptr(lightMVP * model));
-        objectRenderer.BindAndDraw();
-    }
+    // Objects: uLightMVP stays the light's view-projection, models come from the instance buffer
+    glUniformMatrix4fv(loc, 1, GL_FALSE, glm::value_ptr(lightMVP));
+    objectRenderer.DrawInstanced(shader, objectBatch, false);
 }
 
 void P3Scene::OnUpdate() {
@@ -138,34 +152,27 @@ void P3Scene::OnRender(const glm::mat4& view, const glm::mat4& projection) {
     if (config.useLighting) {
         // Lit rendering — litShader is already active from Scene3D::RenderLit
         // Road
+        int modelLoc = litShader.GetUniformLocation("uModel");
         glm::mat4 roadModel = glm::mat4(1.0f);
-        glUniformMatrix4fv(glGetUniformLocation(litShader.programID, "uModel"),
-                           1, GL_FALSE, glm::value_ptr(roadModel));
+        glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(roadModel));
         glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_2D, road.GetTexture());
-        glUniform1i(glGetUniformLocation(litShader.programID, "uTexture"), 0);
         road.DrawGeometry();
 
         // Objects
-        for (const auto& obj : objects) {
-            glm::mat4 model = ModelMatrixFromObject(obj);
-            glUniformMatrix4fv(glGetUniformLocation(litShader.programID, "uModel"),
-                               1, GL_FALSE, glm::value_ptr(model));
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, obj.textureID);
-            glUniform1i(glGetUniformLocation(litShader.programID, "uTexture"), 0);
-            objectRenderer.BindAndDraw();
-        }
+        objectRenderer.DrawInstanced(litShader, objectBatch);
     } else {
         road.Render(view, projection);
-        objectRenderer.Render(objects, view, projection);
+        objectRenderer.Render(objectBatch, view, projection);
     }
 }
 
 void P3Scene::OnUnload() {
     road.Unload();
     objectRenderer.Unload();
-    for (auto tex : loadedTextures) glDeleteTextures(1, &tex);
+    objectBatch.Unload();
+    objectTransforms.Clear();
+    for (auto tex : loadedTextures) TextureManager::Release(tex);
     loadedTextures.clear();
     objects.clear();
 }
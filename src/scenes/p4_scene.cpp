@@ -1,6 +1,8 @@
 #include "scenes/p4_scene.hpp"
+#include "textures/texture_manager.hpp"
 #include "lighting/light.hpp"
-#include "utils/time.hpp"
+#include "utils/interpolate.hpp"
+#include "utils/replay.hpp"
 #include "glad.h"
 #include "glfw3.h"
 #include "imgui.h"
@@ -12,7 +14,11 @@ P4Scene::P4Scene() : Scene3D({
     .name = "Collisions",
     .cameraPos = glm::vec3(0.0f, 15.0f, 50.0f),
     .farPlane = 200.0f,
-    .useLighting = true
+    // The player car can drive anywhere
+    .terrainStreamRadius = 1,
+    .useLighting = true,
+    // Collisions are swept, so a coarse step can't tunnel through thin objects
+    .simulationHz = 30.0f
 }) {}
 
 void P4Scene::OnLoad() {
@@ -20,23 +26,37 @@ void P4Scene::OnLoad() {
     objectRenderer.Load();
     SetupObjects();
     SetupLights();
+    objectTransforms.Build(objects);
+    objectBatch.Add(objects, objectTransforms);
+    objectBatch.Upload();
 
-    // Precompute AABBs for all static objects
-    colliders.reserve(objects.size());
+    // Bin all static objects; rotated ones (tree branches) keep their exact orientation
     for (const auto& obj : objects)
-        colliders.push_back(AABBFromObject(obj));
+        colliders.Insert(OBBFromObject(obj));
 }
 
-void P4Scene::SetupObjects() {
-    unsigned int brickTex = objectRenderer.LoadTexture("resources/textures/objects/building.jpg");
-    unsigned int woodTex  = objectRenderer.LoadTexture("resources/textures/objects/tree_trunk.jpg");
-    unsigned int steelTex = objectRenderer.LoadTexture("resources/textures/objects/steel.jpg");
-    unsigned int carTex   = objectRenderer.LoadTexture("resources/textures/objects/car.jpg");
+void P4Scene::LoadTextures() {
+    if (!loadedTextures.empty()) return;  // already requested by OnPreload
+    loadedTextures.push_back(TextureManager::Load2D("resources/textures/objects/building.jpg"));
+    loadedTextures.push_back(TextureManager::Load2D("resources/textures/objects/tree_trunk.jpg"));
+    loadedTextures.push_back(TextureManager::Load2D("resources/textures/objects/steel.jpg"));
+    loadedTextures.push_back(TextureManager::Load2D("resources/textures/objects/car.jpg"));
+}
+
+void P4Scene::OnPreload() {
+    LoadTextures();
+}
+
+void P4Scene::OnCancelPreload() {
+    for (auto tex : loadedTextures) TextureManager::Release(tex);
+    loadedTextures.clear();
+}
 
-    loadedTextures.push_back(brickTex);
-    loadedTextures.push_back(woodTex);
-    loadedTextures.push_back(steelTex);
-    loadedTextures.push_back(carTex);
+void P4Scene::SetupObjects() {
+    LoadTextures();
+    unsigned int brickTex = loadedTextures[0];
+    unsigned int woodTex  = loadedTextures[1];
+    unsigned int steelTex = loadedTextures[2];
 
     // 5 buildings
     for (int i = 0; i < 5; i++) {
@@ -114,8 +134,9 @@ void P4Scene::SetupLights() {
 
 glm::mat4 P4Scene::GetCarModelMatrix() const {
     glm::mat4 model = glm::mat4(1.0f);
-    model = glm::translate(model, carPos);
-    model = glm::rotate(model, glm::radians(carYaw), glm::vec3(0, 1, 0));
+    model = glm::translate(model, glm::mix(prevCarPos, carPos, interpolationAlpha));
+    model = glm::rotate(model, glm::radians(LerpAngleDegrees(prevCarYaw, carYaw, interpolationAlpha)),
+                        glm::vec3(0, 1, 0));
     model = glm::scale(model, carScale);
     model = glm::translate(model, glm::vec3(0.0f, 1.0f, 0.0f));
     return model;
@@ -126,9 +147,9 @@ void P4Scene::UpdateCar(float dt) {
 
     // Turning (only when moving)
     if (std::abs(carSpeed) > 0.5f) {
-        if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS)
+        if (Replay::KeyDown(window, GLFW_KEY_A))
             carYaw += CAR_TURN_SPEED * dt;
-        if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS)
+        if (Replay::KeyDown(window, GLFW_KEY_D))
             carYaw -= CAR_TURN_SPEED * dt;
     }
 
@@ -140,9 +161,9 @@ void P4Scene::UpdateCar(float dt) {
     float speedMult = onRoad ? 1.5f : 1.0f;
 
     // Acceleration / braking
-    if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS)
+    if (Replay::KeyDown(window, GLFW_KEY_W))
         carSpeed += CAR_ACCEL * dt;
-    else if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS)
+    else if (Replay::KeyDown(window, GLFW_KEY_S))
         carSpeed -= CAR_BRAKE * dt;
     else {
         // Friction
@@ -157,75 +178,69 @@ void P4Scene::UpdateCar(float dt) {
     glm::vec3 forward(std::sin(rad), 0.0f, std::cos(rad));
     glm::vec3 movement = forward * carSpeed * dt;
 
-    // Per-axis collision resolution
-    glm::vec3 newPos = carPos;
-
-    // Try X
-    newPos.x += movement.x;
-    AABB carBox = AABBFromCar(newPos, carHalf);
-    bool hitX = false;
-    for (const auto& col : colliders) {
-        if (carBox.Overlaps(col)) { hitX = true; break; }
-    }
-    if (hitX) {
-        newPos.x = carPos.x;
+    // Swept move: stop at the first contact and slide along it, so thin poles can't be skipped
+    SweepHit contact;
+    glm::vec3 moved = SweepAndSlide(AABBFromCar(carPos, carHalf), movement,
+        [&](const AABB& box, const glm::vec3& delta, SweepHit& hit) {
+            return colliders.Sweep(box, delta, hit);
+        }, &contact);
+    // Tilted colliders give contact normals with a vertical part; the car stays on the ground
+    moved.y = 0.0f;
+    carPos += moved;
+
+    if (contact.id >= 0) {
         collisionTimer = 0.3f;
+        // Head-on hits kill the speed, glancing ones only scrub some of it
+        carSpeed *= 1.0f - std::abs(glm::dot(forward, contact.normal));
     }
 
-    // Try Z
-    newPos.z += movement.z;
-    carBox = AABBFromCar(newPos, carHalf);
-    bool hitZ = false;
-    for (const auto& col : colliders) {
-        if (carBox.Overlaps(col)) { hitZ = true; break; }
-    }
-    if (hitZ) {
-        newPos.z = carPos.z;
-        collisionTimer = 0.3f;
-    }
-
-    // Kill speed on head-on collision
-    if (hitX && hitZ) carSpeed = 0.0f;
-
-    carPos = newPos;
-
     // Decay collision flash
     if (collisionTimer > 0.0f)
         collisionTimer -= dt;
+}
 
-    // Camera follows behind car
-    camera.position = carPos
+void P4Scene::UpdateFollowCamera() {
+    // Follow the interpolated pose so the camera is as smooth as the car
+    glm::vec3 pos = glm::mix(prevCarPos, carPos, interpolationAlpha);
+    float rad = glm::radians(LerpAngleDegrees(prevCarYaw, carYaw, interpolationAlpha));
+    camera.position = pos
         + glm::vec3(-std::sin(rad) * CAM_DISTANCE, CAM_HEIGHT, -std::cos(rad) * CAM_DISTANCE);
-    camera.direction = glm::normalize(carPos + glm::vec3(0, 1, 0) - camera.position);
+    camera.direction = glm::normalize(pos + glm::vec3(0, 1, 0) - camera.position);
+}
+
+void P4Scene::OnFixedUpdate(float dt) {
+    prevCarPos = carPos;
+    prevCarYaw = carYaw;
+    UpdateCar(dt);
+}
+
+uint64_t P4Scene::OnHashState(uint64_t hash) const {
+    hash = HashBytes(&carPos, sizeof(carPos), hash);
+    hash = HashBytes(&carYaw, sizeof(carYaw), hash);
+    return HashBytes(&carSpeed, sizeof(carSpeed), hash);
 }
 
 void P4Scene::OnUpdate() {
-    UpdateCar(Time::deltaTime);
+    UpdateFollowCamera();
 }
 
-void P4Scene::RenderCar(unsigned int shaderID) {
+void P4Scene::RenderCar(int modelLoc) {
     glm::mat4 model = GetCarModelMatrix();
-    glUniformMatrix4fv(glGetUniformLocation(shaderID, "uModel"),
-                       1, GL_FALSE, glm::value_ptr(model));
+    glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_2D, loadedTextures[3]); 
-    glUniform1i(glGetUniformLocation(shaderID, "uTexture"), 0);
     objectRenderer.BindAndDraw();
 }
 
-void P4Scene::OnRenderGeometry(unsigned int shaderID, const glm::mat4& lightMVP) {
-    int loc = glGetUniformLocation(shaderID, "uLightMVP");
+void P4Scene::OnRenderGeometry(Shader& shader, const glm::mat4& lightMVP) {
+    int loc = shader.GetUniformLocation("uLightMVP");
 
     // Road
     glUniformMatrix4fv(loc, 1, GL_FALSE, glm::value_ptr(lightMVP));
     road.DrawGeometry();
 
-    // Static objects
-    for (const auto& obj : objects) {
-        glm::mat4 model = ModelMatrixFromObject(obj);
-        glUniformMatrix4fv(loc, 1, GL_FALSE, glm::value_ptr(lightMVP * model));
-        objectRenderer.BindAndDraw();
-    }
+    // Static objects (uLightMVP is still the bare light matrix from the road)
+    objectRenderer.DrawInstanced(shader, objectBatch, false);
 
     // Car shadow
     glUniformMatrix4fv(loc, 1, GL_FALSE, glm::value_ptr(lightMVP * GetCarModelMatrix()));
@@ -235,30 +250,21 @@ void P4Scene::OnRenderGeometry(unsigned int shaderID, const glm::mat4& lightMVP)
 void P4Scene::OnRender(const glm::mat4& view, const glm::mat4& projection) {
     if (config.useLighting) {
         // Road
+        int modelLoc = litShader.GetUniformLocation("uModel");
         glm::mat4 roadModel = glm::mat4(1.0f);
-        glUniformMatrix4fv(glGetUniformLocation(litShader.programID, "uModel"),
-                           1, GL_FALSE, glm::value_ptr(roadModel));
+        glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(roadModel));
         glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_2D, road.GetTexture());
-        glUniform1i(glGetUniformLocation(litShader.programID, "uTexture"), 0);
         road.DrawGeometry();
 
         // Static objects
-        for (const auto& obj : objects) {
-            glm::mat4 model = ModelMatrixFromObject(obj);
-            glUniformMatrix4fv(glGetUniformLocation(litShader.programID, "uModel"),
-                               1, GL_FALSE, glm::value_ptr(model));
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, obj.textureID);
-            glUniform1i(glGetUniformLocation(litShader.programID, "uTexture"), 0);
-            objectRenderer.BindAndDraw();
-        }
+        objectRenderer.DrawInstanced(litShader, objectBatch);
 
         // Car
-        RenderCar(litShader.programID);
+        RenderCar(modelLoc);
     } else {
         road.Render(view, projection);
-        objectRenderer.Render(objects, view, projection);
+        objectRenderer.Render(objectBatch, view, projection);
     }
 
     // Collision flash indicator
@@ -282,8 +288,10 @@ void P4Scene::OnRender(const glm::mat4& view, const glm::mat4& projection) {
 void P4Scene::OnUnload() {
     road.Unload();
     objectRenderer.Unload();
-    for (auto tex : loadedTextures) glDeleteTextures(1, &tex);
+    objectBatch.Unload();
+    objectTransforms.Clear();
+    for (auto tex : loadedTextures) TextureManager::Release(tex);
     loadedTextures.clear();
     objects.clear();
-    colliders.clear();
+    colliders.Clear();
 }
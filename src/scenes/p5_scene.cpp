@@ -1,6 +1,9 @@
 #include "scenes/p5_scene.hpp"
+#include "textures/texture_manager.hpp"
 #include "lighting/light.hpp"
-#include "utils/time.hpp"
+#include "utils/interpolate.hpp"
+#include "utils/replay.hpp"
+#include "ecs/systems.hpp"
 #include "glad.h"
 #include "glfw3.h"
 #include "imgui.h"
@@ -13,7 +16,11 @@ P5Scene::P5Scene() : Scene3D({
     .name = "Random and AI Cars",
     .cameraPos = glm::vec3(0.0f, 15.0f, 50.0f),
     .farPlane = 200.0f,
-    .useLighting = true
+    // The player car can drive anywhere
+    .terrainStreamRadius = 1,
+    .useLighting = true,
+    // The player car is swept; AI cars and wanderers move slowly enough per step
+    .simulationHz = 30.0f
 }) {}
 
 void P5Scene::OnLoad() {
@@ -21,42 +28,40 @@ void P5Scene::OnLoad() {
     objectRenderer.Load();
     SetupObjects();
     SetupLights();
+    objectTransforms.Build(objects);
+    objectBatch.Add(objects, objectTransforms);
+    objectBatch.Upload();
 
     // Static colliders
-    staticColliders.reserve(objects.size());
     for (const auto& obj : objects)
-        staticColliders.push_back(AABBFromObject(obj));
+        staticColliders.Insert(OBBFromObject(obj));
 
-    // 2 AI cars at opposite sides of the ellipse
-    aiCars.push_back({ 0.0f, 0.8f, glm::vec3(0), 0.0f });
-    aiCars.push_back({ glm::radians(180.0f), 1.1f, glm::vec3(0), 0.0f });
+    SpawnAgents();
+}
 
-    // 5 wandering cubes spawned between road and buildings
-    srand(42);
-    for (int i = 0; i < 5; i++) {
-        float angle = glm::radians(i * 72.0f + 15.0f);
-        float radius = 42.0f + (rand() % 4);
-        glm::vec3 pos(radius * std::cos(angle), 0.0f, radius * std::sin(angle));
+void P5Scene::LoadTextures() {
+    if (!loadedTextures.empty()) return;  // already requested by OnPreload
+    loadedTextures.push_back(TextureManager::Load2D("resources/textures/objects/building.jpg"));
+    loadedTextures.push_back(TextureManager::Load2D("resources/textures/objects/tree_trunk.jpg"));
+    loadedTextures.push_back(TextureManager::Load2D("resources/textures/objects/steel.jpg"));
+    loadedTextures.push_back(TextureManager::Load2D("resources/textures/objects/car.jpg"));
+    loadedTextures.push_back(TextureManager::Load2D("resources/textures/objects/cube.jpg"));
+}
 
-        float dirAngle = glm::radians((float)(rand() % 360));
-        glm::vec3 dir(std::cos(dirAngle), 0.0f, std::sin(dirAngle));
+void P5Scene::OnPreload() {
+    LoadTextures();
+}
 
-        wanderCubes.push_back({ pos, dir, 3.0f + (float)(rand() % 3) });
-    }
+void P5Scene::OnCancelPreload() {
+    for (auto tex : loadedTextures) TextureManager::Release(tex);
+    loadedTextures.clear();
 }
 
 void P5Scene::SetupObjects() {
-    unsigned int brickTex = objectRenderer.LoadTexture("resources/textures/objects/building.jpg");
-    unsigned int woodTex  = objectRenderer.LoadTexture("resources/textures/objects/tree_trunk.jpg");
-    unsigned int steelTex = objectRenderer.LoadTexture("resources/textures/objects/steel.jpg");
-    unsigned int carTex   = objectRenderer.LoadTexture("resources/textures/objects/car.jpg");
-    unsigned int cubeTex  = objectRenderer.LoadTexture("resources/textures/objects/cube.jpg");
-
-    loadedTextures.push_back(brickTex);
-    loadedTextures.push_back(woodTex);
-    loadedTextures.push_back(steelTex);
-    loadedTextures.push_back(carTex);
-    loadedTextures.push_back(cubeTex);
+    LoadTextures();
+    unsigned int brickTex = loadedTextures[0];
+    unsigned int woodTex  = loadedTextures[1];
+    unsigned int steelTex = loadedTextures[2];
 
     for (int i = 0; i < 5; i++) {
         float angle = glm::radians(i * 72.0f);
@@ -122,111 +127,91 @@ void P5Scene::SetupLights() {
     }
 }
 
-// Model matrices
+// Agents
 
-glm::mat4 P5Scene::GetPlayerCarModel() const {
-    glm::mat4 m = glm::mat4(1.0f);
-    m = glm::translate(m, carPos);
-    m = glm::rotate(m, glm::radians(carYaw), glm::vec3(0,1,0));
-    m = glm::scale(m, carScale);
-    m = glm::translate(m, glm::vec3(0, 1, 0));
-    return m;
-}
+void P5Scene::SpawnAgents() {
+    unsigned int carTex  = loadedTextures[3];
+    unsigned int cubeTex = loadedTextures[4];
 
-glm::mat4 P5Scene::GetAICarModel(const AICar& ai) const {
-    glm::mat4 m = glm::mat4(1.0f);
-    m = glm::translate(m, ai.pos);
-    m = glm::rotate(m, glm::radians(ai.yaw), glm::vec3(0,1,0));
-    m = glm::scale(m, aiCarScale);
-    m = glm::translate(m, glm::vec3(0, 1, 0));
-    return m;
-}
+    Transform start;
+    start.pos = start.prevPos = glm::vec3(ROAD_RX, 0.0f, 0.0f);
+    player = world.Create(start, Agent{ FootprintRadius(carHalf), CAR_MAX_SPEED }, RenderMesh{ carScale, 1.0f, carTex });
 
-glm::mat4 P5Scene::GetWanderCubeModel(const WanderCube& wc) const {
-    glm::mat4 m = glm::mat4(1.0f);
-    m = glm::translate(m, wc.pos);
-    m = glm::scale(m, wanderScale);
-    m = glm::translate(m, glm::vec3(0, 0.5f, 0));
-    return m;
-}
+    // 2 AI cars at opposite sides of the ellipse
+    TrackFollower tracks[] = {
+        { ROAD_RX, ROAD_RZ, 0.0f, 0.8f },
+        { ROAD_RX, ROAD_RZ, glm::radians(180.0f), 1.1f },
+    };
+    for (TrackFollower& f : tracks) {
+        Transform t;
+        AdvanceOnTrack(t, f, 0.0f);
+        t.prevPos = t.pos;
+        t.prevYaw = t.yaw;
+        world.Create(t, f, Collider{ aiCarHalf }, Agent{ FootprintRadius(aiCarHalf), f.speed * ROAD_RX },
+                     RenderMesh{ aiCarScale, 1.0f, carTex });
+        aiCarCount++;
+    }
 
-// Update
+    // 5 wandering cubes spawned between road and buildings
+    for (int i = 0; i < 5; i++) {
+        float angle = glm::radians(i * 72.0f + 15.0f);
+        float radius = 42.0f + (rand() % 4);
+        Transform t;
+        t.pos = t.prevPos = glm::vec3(radius * std::cos(angle), 0.0f, radius * std::sin(angle));
 
-void P5Scene::CollectDynamicColliders(std::vector<AABB>& out) const {
-    for (const auto& ai : aiCars)
-        out.push_back(AABBFromCar(ai.pos, aiCarHalf));
-    for (const auto& wc : wanderCubes)
-        out.push_back(AABBFromCar(wc.pos, wanderHalf));
-}
+        float dirAngle = glm::radians((float)(rand() % 360));
+        float speed = 3.0f + (float)(rand() % 3);
+        Velocity v{ glm::vec3(std::cos(dirAngle), 0.0f, std::sin(dirAngle)) * speed };
 
-void P5Scene::UpdateAICars(float dt) {
-    for (auto& ai : aiCars) {
-        ai.angle += ai.speed * dt;
-        if (ai.angle > 2.0f * 3.14159265f) ai.angle -= 2.0f * 3.14159265f;
-
-        ai.pos = glm::vec3(
-            ROAD_RX * std::cos(ai.angle),
-            0.0f,
-            ROAD_RZ * std::sin(ai.angle)
-        );
-
-        // Yaw from ellipse tangent
-        float tx = -ROAD_RX * std::sin(ai.angle);
-        float tz =  ROAD_RZ * std::cos(ai.angle);
-        ai.yaw = glm::degrees(std::atan2(tx, tz));
+        world.Create(t, v, Collider{ wanderHalf }, Agent{ FootprintRadius(wanderHalf), speed },
+                     RenderMesh{ wanderScale, 0.5f, cubeTex });
+        wanderCubeCount++;
     }
+
+    SyncColliders(world, dynamicColliders);
 }
 
 void P5Scene::UpdateWanderCubes(float dt) {
-    for (auto& wc : wanderCubes) {
-        glm::vec3 movement = wc.dir * wc.speed * dt;
-        glm::vec3 newPos = wc.pos;
-
-        // Try X
-        newPos.x += movement.x;
-        AABB box = AABBFromCar(newPos, wanderHalf);
-        bool hitX = false;
-        for (const auto& col : staticColliders) {
-            if (box.Overlaps(col)) { hitX = true; break; }
-        }
-        if (hitX) {
-            newPos.x = wc.pos.x;
-            wc.dir.x = -wc.dir.x;
-        }
-
-        // Try Z
-        newPos.z += movement.z;
-        box = AABBFromCar(newPos, wanderHalf);
-        bool hitZ = false;
-        for (const auto& col : staticColliders) {
-            if (box.Overlaps(col)) { hitZ = true; break; }
-        }
-        if (hitZ) {
-            newPos.z = wc.pos.z;
-            wc.dir.z = -wc.dir.z;
-        }
-
-        wc.pos = newPos;
-    }
+    world.EachColumns<Transform, Velocity, Agent, Collider>(
+        [&](int count, const Entity*, Transform* t, Velocity* v, Agent* a, Collider* c) {
+            for (int i = 0; i < count; i++) {
+                // Avoidance is only a preference; buildings and other agents still block. Contacts
+                // the cube is already in don't, so it can always back out.
+                AABB current = AABBFromCar(t[i].pos, c[i].half);
+                MoveAgentAndBounce(t[i], a[i], v[i], dt, [&](const glm::vec3& pos) {
+                    AABB box = AABBFromCar(pos, c[i].half);
+                    if (staticColliders.Overlaps(box)) return true;
+                    bool hit = false;
+                    dynamicColliders.Query(box, [&](int proxy) {
+                        const AABB& other = dynamicColliders.Box(proxy);
+                        hit = proxy != c[i].proxy && other.Overlaps(box) && !other.Overlaps(current);
+                        return !hit;
+                    });
+                    return hit;
+                });
+            }
+        });
 }
 
 void P5Scene::UpdatePlayerCar(float dt) {
     GLFWwindow* window = glfwGetCurrentContext();
 
+    Transform& car = world.Get<Transform>(player);
+
     if (std::abs(carSpeed) > 0.5f) {
-        if (glfwGetKey(window, GLFW_KEY_A) == GLFW_PRESS) carYaw += CAR_TURN_SPEED * dt;
-        if (glfwGetKey(window, GLFW_KEY_D) == GLFW_PRESS) carYaw -= CAR_TURN_SPEED * dt;
+        if (Replay::KeyDown(window, GLFW_KEY_A)) car.yaw += CAR_TURN_SPEED * dt;
+        if (Replay::KeyDown(window, GLFW_KEY_D)) car.yaw -= CAR_TURN_SPEED * dt;
     }
 
     // Road detection: on road if between inner ellipse (35,25) and outer ellipse (40,30)
-    float ex = carPos.x, ez = carPos.z;
+    float ex = car.pos.x, ez = car.pos.z;
     float eOuter = (ex/40.0f)*(ex/40.0f) + (ez/30.0f)*(ez/30.0f);
     float eInner = (ex/35.0f)*(ex/35.0f) + (ez/25.0f)*(ez/25.0f);
     bool onRoad = (eOuter <= 1.0f && eInner >= 1.0f);
     float speedMult = onRoad ? 1.5f : 1.0f;
 
-    if (glfwGetKey(window, GLFW_KEY_W) == GLFW_PRESS) carSpeed += CAR_ACCEL * dt;
-    else if (glfwGetKey(window, GLFW_KEY_S) == GLFW_PRESS) carSpeed -= CAR_BRAKE * dt;
+    if (Replay::KeyDown(window, GLFW_KEY_W)) carSpeed += CAR_ACCEL * dt;
+    else if (Replay::KeyDown(window, GLFW_KEY_S)) carSpeed -= CAR_BRAKE * dt;
     else {
         if (carSpeed > 0) carSpeed = glm::max(0.0f, carSpeed - CAR_FRICTION * dt);
         else if (carSpeed < 0) carSpeed = glm::min(0.0f, carSpeed + CAR_FRICTION * dt);
@@ -234,131 +219,98 @@ void P5Scene::UpdatePlayerCar(float dt) {
     float maxSpd = CAR_MAX_SPEED * speedMult;
     carSpeed = glm::clamp(carSpeed, -maxSpd * 0.5f, maxSpd);
 
-    float rad = glm::radians(carYaw);
+    float rad = glm::radians(car.yaw);
     glm::vec3 forward(std::sin(rad), 0, std::cos(rad));
     glm::vec3 movement = forward * carSpeed * dt;
 
-    // Collect ALL colliders: static + dynamic
-    std::vector<AABB> allColliders = staticColliders;
-    CollectDynamicColliders(allColliders);
-
-    glm::vec3 newPos = carPos;
-
-    newPos.x += movement.x;
-    AABB carBox = AABBFromCar(newPos, carHalf);
-    bool hitX = false;
-    for (const auto& col : allColliders) {
-        if (carBox.Overlaps(col)) { hitX = true; break; }
+    // Swept against buildings and moving traffic, sliding along whatever is hit first
+    SweepHit contact;
+    glm::vec3 moved = SweepAndSlide(AABBFromCar(car.pos, carHalf), movement,
+        [&](const AABB& box, const glm::vec3& delta, SweepHit& hit) {
+            SweepHit dynamicHit;
+            bool hitStatic = staticColliders.Sweep(box, delta, hit);
+            bool hitDynamic = dynamicColliders.Sweep(box, delta, dynamicHit);
+            if (hitDynamic && (!hitStatic || dynamicHit.t < hit.t)) hit = dynamicHit;
+            return hitStatic || hitDynamic;
+        }, &contact);
+    // Tilted colliders give contact normals with a vertical part; the car stays on the ground
+    moved.y = 0.0f;
+    car.pos += moved;
+
+    if (contact.id >= 0) {
+        collisionTimer = 0.3f;
+        carSpeed *= 1.0f - std::abs(glm::dot(forward, contact.normal));
     }
-    if (hitX) { newPos.x = carPos.x; collisionTimer = 0.3f; }
-
-    newPos.z += movement.z;
-    carBox = AABBFromCar(newPos, carHalf);
-    bool hitZ = false;
-    for (const auto& col : allColliders) {
-        if (carBox.Overlaps(col)) { hitZ = true; break; }
-    }
-    if (hitZ) { newPos.z = carPos.z; collisionTimer = 0.3f; }
-
-    if (hitX && hitZ) carSpeed = 0.0f;
-    carPos = newPos;
 
     if (collisionTimer > 0) collisionTimer -= dt;
+}
 
-    camera.position = carPos + glm::vec3(-std::sin(rad)*CAM_DISTANCE, CAM_HEIGHT, -std::cos(rad)*CAM_DISTANCE);
-    camera.direction = glm::normalize(carPos + glm::vec3(0,1,0) - camera.position);
+void P5Scene::UpdateFollowCamera() {
+    const Transform& car = world.Get<Transform>(player);
+    glm::vec3 pos = glm::mix(car.prevPos, car.pos, interpolationAlpha);
+    float rad = glm::radians(LerpAngleDegrees(car.prevYaw, car.yaw, interpolationAlpha));
+    camera.position = pos + glm::vec3(-std::sin(rad)*CAM_DISTANCE, CAM_HEIGHT, -std::cos(rad)*CAM_DISTANCE);
+    camera.direction = glm::normalize(pos + glm::vec3(0,1,0) - camera.position);
 }
 
-void P5Scene::OnUpdate() {
-    float dt = Time::deltaTime;
-    UpdateAICars(dt);
+void P5Scene::OnFixedUpdate(float dt) {
+    StorePreviousTransforms(world);
+    avoidance.Step(world);
+    FollowTracks(world, dt);
     UpdateWanderCubes(dt);
+    // The player sweeps against where the traffic is after this step
+    SyncColliders(world, dynamicColliders);
     UpdatePlayerCar(dt);
+    ObserveVelocities(world, dt);
 }
 
-// Rendering
+uint64_t P5Scene::OnHashState(uint64_t hash) const {
+    hash = HashBytes(&carSpeed, sizeof(carSpeed), hash);
+    return HashSimulationState(world, hash);
+}
 
-void P5Scene::RenderDynamic(unsigned int shaderID) {
-    // Player car
-    glUniformMatrix4fv(glGetUniformLocation(shaderID, "uModel"),
-                       1, GL_FALSE, glm::value_ptr(GetPlayerCarModel()));
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, loadedTextures[3]); // carTex
-    glUniform1i(glGetUniformLocation(shaderID, "uTexture"), 0);
-    objectRenderer.BindAndDraw();
-
-    // AI cars (brick texture for contrast)
-    for (const auto& ai : aiCars) {
-        glUniformMatrix4fv(glGetUniformLocation(shaderID, "uModel"),
-                           1, GL_FALSE, glm::value_ptr(GetAICarModel(ai)));
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, loadedTextures[3]); // carTex
-        glUniform1i(glGetUniformLocation(shaderID, "uTexture"), 0);
-        objectRenderer.BindAndDraw();
-    }
+void P5Scene::OnUpdate() {
+    UpdateFollowCamera();
+    // Interpolated poses are fixed for the frame, shared by the shadow and lit passes
+    BuildDynamicBatch();
+}
 
-    // Wandering cubes (rainbow texture)
-    for (const auto& wc : wanderCubes) {
-        glUniformMatrix4fv(glGetUniformLocation(shaderID, "uModel"),
-                           1, GL_FALSE, glm::value_ptr(GetWanderCubeModel(wc)));
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, loadedTextures[4]); // cubeTex
-        glUniform1i(glGetUniformLocation(shaderID, "uTexture"), 0);
-        objectRenderer.BindAndDraw();
-    }
+// Rendering
+
+void P5Scene::BuildDynamicBatch() {
+    dynamicBatch.Clear();
+    SubmitInstances(world, interpolationAlpha, dynamicBatch);
+    dynamicBatch.Upload();
 }
 
-void P5Scene::OnRenderGeometry(unsigned int shaderID, const glm::mat4& lightMVP) {
-    int loc = glGetUniformLocation(shaderID, "uLightMVP");
+void P5Scene::OnRenderGeometry(Shader& shader, const glm::mat4& lightMVP) {
+    int loc = shader.GetUniformLocation("uLightMVP");
 
     glUniformMatrix4fv(loc, 1, GL_FALSE, glm::value_ptr(lightMVP));
     road.DrawGeometry();
 
-    for (const auto& obj : objects) {
-        glm::mat4 model = ModelMatrixFromObject(obj);
-        glUniformMatrix4fv(loc, 1, GL_FALSE, glm::value_ptr(lightMVP * model));
-        objectRenderer.BindAndDraw();
-    }
-
-    // Dynamic shadows
-    glUniformMatrix4fv(loc, 1, GL_FALSE, glm::value_ptr(lightMVP * GetPlayerCarModel()));
-    objectRenderer.BindAndDraw();
-    for (const auto& ai : aiCars) {
-        glUniformMatrix4fv(loc, 1, GL_FALSE, glm::value_ptr(lightMVP * GetAICarModel(ai)));
-        objectRenderer.BindAndDraw();
-    }
-    for (const auto& wc : wanderCubes) {
-        glUniformMatrix4fv(loc, 1, GL_FALSE, glm::value_ptr(lightMVP * GetWanderCubeModel(wc)));
-        objectRenderer.BindAndDraw();
-    }
+    // Static and dynamic shadows, models from the instance buffers
+    objectRenderer.DrawInstanced(shader, objectBatch, false);
+    objectRenderer.DrawInstanced(shader, dynamicBatch, false);
 }
 
 void P5Scene::OnRender(const glm::mat4& view, const glm::mat4& projection) {
     if (config.useLighting) {
         // Road
-        glUniformMatrix4fv(glGetUniformLocation(litShader.programID, "uModel"),
-                           1, GL_FALSE, glm::value_ptr(glm::mat4(1)));
+        int modelLoc = litShader.GetUniformLocation("uModel");
+        glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(glm::mat4(1)));
         glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_2D, road.GetTexture());
-        glUniform1i(glGetUniformLocation(litShader.programID, "uTexture"), 0);
         road.DrawGeometry();
 
         // Static objects
-        for (const auto& obj : objects) {
-            glm::mat4 model = ModelMatrixFromObject(obj);
-            glUniformMatrix4fv(glGetUniformLocation(litShader.programID, "uModel"),
-                               1, GL_FALSE, glm::value_ptr(model));
-            glActiveTexture(GL_TEXTURE0);
-            glBindTexture(GL_TEXTURE_2D, obj.textureID);
-            glUniform1i(glGetUniformLocation(litShader.programID, "uTexture"), 0);
-            objectRenderer.BindAndDraw();
-        }
+        objectRenderer.DrawInstanced(litShader, objectBatch);
 
         // All dynamic objects
-        RenderDynamic(litShader.programID);
+        objectRenderer.DrawInstanced(litShader, dynamicBatch);
     } else {
         road.Render(view, projection);
-        objectRenderer.Render(objects, view, projection);
+        objectRenderer.Render(objectBatch, view, projection);
     }
 
     // Collision flash
@@ -374,18 +326,25 @@ void P5Scene::OnRender(const glm::mat4& view, const glm::mat4& projection) {
     // HUD
     ImGui::Begin("Car");
     ImGui::Text("Speed: %.1f", carSpeed);
-    ImGui::Text("Position: (%.1f, %.1f)", carPos.x, carPos.z);
-    ImGui::Text("AI Cars: %d | Wanderers: %d", (int)aiCars.size(), (int)wanderCubes.size());
+    const Transform& car = world.Get<Transform>(player);
+    ImGui::Text("Position: (%.1f, %.1f)", car.pos.x, car.pos.z);
+    ImGui::Text("AI Cars: %d | Wanderers: %d", aiCarCount, wanderCubeCount);
     ImGui::End();
 }
 
 void P5Scene::OnUnload() {
     road.Unload();
     objectRenderer.Unload();
-    for (auto tex : loadedTextures) glDeleteTextures(1, &tex);
+    objectBatch.Unload();
+    objectTransforms.Clear();
+    dynamicBatch.Unload();
+    for (auto tex : loadedTextures) TextureManager::Release(tex);
     loadedTextures.clear();
     objects.clear();
-    staticColliders.clear();
-    aiCars.clear();
-    wanderCubes.clear();
+    staticColliders.Clear();
+    dynamicColliders.Clear();
+    world.Clear();
+    player = ECS_NULL_ENTITY;
+    aiCarCount = 0;
+    wanderCubeCount = 0;
 }
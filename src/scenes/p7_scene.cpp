@@ -0,0 +1,328 @@
+#include "scenes/p7_scene.hpp"
+#include "textures/texture_manager.hpp"
+#include "lighting/light.hpp"
+#include "utils/profiler.hpp"
+#include "utils/replay.hpp"
+#include "ecs/systems.hpp"
+#include "glad.h"
+#include "imgui.h"
+#include <glm/gtc/type_ptr.hpp>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <random>
+
+static const float TWO_PI = 2.0f * 3.14159265f;
+
+P7Scene::P7Scene() : Scene3D({
+    .name = "Traffic Stress",
+    .cameraPos = glm::vec3(0.0f, 120.0f, 300.0f),
+    .farPlane = 3000.0f,
+    .useLighting = true,
+    .simulationHz = 30.0f,
+    // A slow step must not turn into a spiral of catch-up steps
+    .maxSimulationSteps = 2
+}) {}
+
+void P7Scene::OnLoad() {
+    objectRenderer.Load();
+
+    DirectionalLight sun;
+    sun.direction = glm::vec3(-0.5f, -1.0f, -0.3f);
+    sun.color = glm::vec3(1.0f, 0.95f, 0.8f);
+    sun.intensity = 0.9f;
+    lighting.SetSun(sun);
+
+    Spawn();
+
+    camera.position = glm::vec3(0.0f, worldRadius * 0.4f, worldRadius * 1.1f);
+    camera.pitch = -25.0f;
+    camera.maxSpeed = 200.0f;
+}
+
+void P7Scene::LoadTextures() {
+    if (!loadedTextures.empty()) return;  // already requested by OnPreload
+    loadedTextures.push_back(TextureManager::Load2D("resources/textures/objects/building.jpg"));
+    loadedTextures.push_back(TextureManager::Load2D("resources/textures/objects/car.jpg"));
+    loadedTextures.push_back(TextureManager::Load2D("resources/textures/objects/cube.jpg"));
+}
+
+void P7Scene::OnPreload() {
+    LoadTextures();
+}
+
+void P7Scene::OnCancelPreload() {
+    for (auto tex : loadedTextures) TextureManager::Release(tex);
+    loadedTextures.clear();
+}
+
+// Spawning
+
+glm::vec3 P7Scene::TrackPoint(const Track& track, float angle) const {
+    return glm::vec3(track.rx * std::cos(angle), 0.0f, track.rz * std::sin(angle));
+}
+
+void P7Scene::Spawn() {
+    LoadTextures();
+    unsigned int brickTex = loadedTextures[0];
+
+    // Seeded locally so a respawn with the same settings is the same load
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    // Size the innermost track so the busiest one still has CAR_SPACING per car
+    int carsPerTrack = (carCount + trackCount - 1) / trackCount;
+    float perimeterPerRadius = TWO_PI * (1.0f + TRACK_ASPECT) * 0.5f;
+    float innerRx = std::max(30.0f, carsPerTrack * CAR_SPACING / perimeterPerRadius);
+    for (int k = 0; k < trackCount; k++) {
+        float rx = innerRx + k * TRACK_GAP;
+        tracks.push_back({ rx, rx * TRACK_ASPECT });
+    }
+    worldRadius = tracks.back().rx + TRACK_GAP;
+
+    // Buildings midway between neighbouring tracks, about one every 20 units
+    for (int k = 0; k + 1 < trackCount; k++) {
+        Track mid = { tracks[k].rx + TRACK_GAP * 0.5f, tracks[k].rz + TRACK_GAP * 0.5f };
+        int count = (int)(mid.rx * perimeterPerRadius / 20.0f);
+        for (int i = 0; i < count; i++) {
+            float angle = (i + unit(rng) * 0.5f) * TWO_PI / count;
+            float height = 4.0f + unit(rng) * 8.0f;
+            buildings.push_back({ TrackPoint(mid, angle), glm::vec3(3.0f, height, 3.0f), brickTex });
+        }
+    }
+    buildingTransforms.Build(buildings);
+    buildingBatch.Add(buildings, buildingTransforms);
+    buildingBatch.Upload();
+    for (const auto& b : buildings)
+        staticColliders.Insert(OBBFromObject(b));
+
+    // Cars spread evenly around their track
+    unsigned int carTex = loadedTextures[1];
+    unsigned int cubeTex = loadedTextures[2];
+    for (int i = 0; i < carCount; i++) {
+        int track = i % trackCount;
+        int slot = i / trackCount;
+        int onTrack = carCount / trackCount + (track < carCount % trackCount ? 1 : 0);
+        const Track& t = tracks[track];
+
+        TrackFollower follower = { t.rx, t.rz, (slot + unit(rng) * 0.3f) * TWO_PI / onTrack,
+                                   (8.0f + unit(rng) * 6.0f) / ((t.rx + t.rz) * 0.5f) };
+        Transform transform;
+        AdvanceOnTrack(transform, follower, 0.0f);
+        transform.prevPos = transform.pos;
+        transform.prevYaw = transform.yaw;
+        int proxy = dynamicColliders.CreateProxy(AABBFromCar(transform.pos, carHalf), TAG_CAR);
+        world.Create(transform, follower, Collider{ carHalf, TAG_CAR, proxy },
+                     Agent{ FootprintRadius(carHalf), follower.speed * t.rx }, RenderMesh{ carScale, 0.5f, carTex });
+    }
+    spawnedCars = carCount;
+
+    // Wanderers anywhere in the world disk, but not inside a building or another agent
+    for (int i = 0; i < wandererCount; i++) {
+        glm::vec3 pos;
+        for (int attempt = 0; attempt < 8; attempt++) {
+            float r = worldRadius * std::sqrt(unit(rng));
+            float a = unit(rng) * TWO_PI;
+            pos = glm::vec3(r * std::cos(a), 0.0f, r * TRACK_ASPECT * std::sin(a));
+            AABB box = AABBFromCar(pos, wanderHalf);
+            if (!staticColliders.Overlaps(box) && !dynamicColliders.Overlaps(box)) break;
+        }
+        float dirAngle = unit(rng) * TWO_PI;
+        float speed = 2.0f + unit(rng) * 3.0f;
+
+        Transform transform;
+        transform.pos = transform.prevPos = pos;
+        Velocity velocity = { glm::vec3(std::cos(dirAngle), 0.0f, std::sin(dirAngle)) * speed };
+        int proxy = dynamicColliders.CreateProxy(AABBFromCar(pos, wanderHalf), TAG_WANDERER);
+        world.Create(transform, velocity, Collider{ wanderHalf, TAG_WANDERER, proxy },
+                     Agent{ FootprintRadius(wanderHalf), speed }, RenderMesh{ wanderScale, 0.5f, cubeTex });
+    }
+    spawnedWanderers = wandererCount;
+
+    std::fill(std::begin(stepMs), std::end(stepMs), 0.0f);
+    stepIndex = 0;
+}
+
+void P7Scene::Despawn() {
+    buildingBatch.Unload();
+    buildingTransforms.Clear();
+    buildings.clear();
+    staticColliders.Clear();
+    dynamicColliders.Clear();
+    tracks.clear();
+    world.Clear();
+    spawnedCars = 0;
+    spawnedWanderers = 0;
+}
+
+// Update
+
+void P7Scene::UpdateCars(float dt) {
+    PROFILE_SCOPE("Traffic cars");
+    std::atomic<int> queries{0}, blockedCars{0};
+
+    world.ParallelColumns<Transform, TrackFollower, Collider>(AGENT_GRAIN,
+        [&](int count, const Entity*, Transform* t, TrackFollower* f, Collider* c) {
+            int chunkQueries = 0, chunkBlocked = 0;
+            for (int i = 0; i < count; i++) {
+                // Hold position while another car is just ahead; wanderers get out of the way themselves
+                float rad = glm::radians(t[i].yaw);
+                AABB probe = AABBFromCar(t[i].pos + glm::vec3(std::sin(rad), 0.0f, std::cos(rad)) * LOOKAHEAD,
+                                         c[i].half);
+                bool blocked = false;
+                chunkQueries++;
+                dynamicColliders.Query(probe, [&](int proxy) {
+                    blocked = proxy != c[i].proxy && dynamicColliders.UserData(proxy) == TAG_CAR &&
+                              dynamicColliders.Box(proxy).Overlaps(probe);
+                    return !blocked;
+                });
+                if (blocked) {
+                    chunkBlocked++;
+                    continue;
+                }
+                AdvanceOnTrack(t[i], f[i], dt);
+            }
+            queries += chunkQueries;
+            blockedCars += chunkBlocked;
+        });
+
+    stepQueries += queries;
+    stepBlockedCars = blockedCars;
+}
+
+void P7Scene::UpdateWanderers(float dt) {
+    PROFILE_SCOPE("Traffic wanderers");
+    std::atomic<int> queries{0};
+
+    world.ParallelColumns<Transform, Velocity, Agent, Collider>(AGENT_GRAIN,
+        [&](int count, const Entity*, Transform* t, Velocity* v, Agent* a, Collider* c) {
+            int chunkQueries = 0;
+            for (int i = 0; i < count; i++) {
+                // Only contacts the cube isn't already in block it, so it can always back out
+                AABB current = AABBFromCar(t[i].pos, c[i].half);
+                MoveAgentAndBounce(t[i], a[i], v[i], dt, [&](const glm::vec3& pos) {
+                    AABB box = AABBFromCar(pos, c[i].half);
+                    chunkQueries += 2;
+                    if (staticColliders.Overlaps(box)) return true;
+                    bool hit = false;
+                    dynamicColliders.Query(box, [&](int proxy) {
+                        const AABB& other = dynamicColliders.Box(proxy);
+                        hit = proxy != c[i].proxy && other.Overlaps(box) && !other.Overlaps(current);
+                        return !hit;
+                    });
+                    return hit;
+                });
+
+                // Turn back at the edge of the world
+                const glm::vec3& pos = t[i].pos;
+                float ex = pos.x / worldRadius, ez = pos.z / (worldRadius * TRACK_ASPECT);
+                if (ex * ex + ez * ez > 1.0f)
+                    v[i].linear = glm::normalize(glm::vec3(-pos.x, 0.0f, -pos.z)) * a[i].maxSpeed;
+            }
+            queries += chunkQueries;
+        });
+
+    stepQueries += queries;
+}
+
+void P7Scene::OnFixedUpdate(float dt) {
+    auto start = std::chrono::steady_clock::now();
+
+    StorePreviousTransforms(world);
+    avoidance.Step(world);
+    stepAvoidanceQueries = avoidance.Queries();
+    stepQueries = stepAvoidanceQueries;
+    UpdateCars(dt);
+    UpdateWanderers(dt);
+    // Tree moves in storage order, so it is built the same way whatever the thread count
+    SyncColliders(world, dynamicColliders);
+    ObserveVelocities(world, dt);
+    collisionQueries += stepQueries;
+
+    stepMs[stepIndex % TRAFFIC_HISTORY] =
+        std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+    stepIndex++;
+}
+
+uint64_t P7Scene::OnHashState(uint64_t hash) const {
+    return HashSimulationState(world, hash);
+}
+
+void P7Scene::OnUpdate() {
+    BuildDynamicBatch();
+}
+
+// Rendering
+
+void P7Scene::BuildDynamicBatch() {
+    PROFILE_SCOPE("Traffic batch");
+    dynamicBatch.Clear();
+    SubmitInstances(world, interpolationAlpha, dynamicBatch);
+    dynamicBatch.Upload();
+}
+
+void P7Scene::OnRenderGeometry(Shader& shader, const glm::mat4& lightMVP) {
+    glUniformMatrix4fv(shader.GetUniformLocation("uLightMVP"), 1, GL_FALSE, glm::value_ptr(lightMVP));
+    objectRenderer.DrawInstanced(shader, buildingBatch, false);
+    objectRenderer.DrawInstanced(shader, dynamicBatch, false);
+}
+
+void P7Scene::OnRender(const glm::mat4& view, const glm::mat4& projection) {
+    if (config.useLighting) {
+        objectRenderer.DrawInstanced(litShader, buildingBatch);
+        objectRenderer.DrawInstanced(litShader, dynamicBatch);
+    } else {
+        objectRenderer.Render(buildingBatch, view, projection);
+        objectRenderer.Render(dynamicBatch, view, projection);
+    }
+
+    RenderStatsUI();
+}
+
+void P7Scene::RenderStatsUI() {
+    ImGui::Begin("Traffic");
+
+    ImGui::SliderInt("Cars", &carCount, 0, 20000);
+    ImGui::SliderInt("Wanderers", &wandererCount, 0, 100000);
+    ImGui::SliderInt("Tracks", &trackCount, 1, 32);
+    ImGui::InputScalar("Seed", ImGuiDataType_U32, &seed);
+    if (ImGui::Button("Respawn")) {
+        Despawn();
+        Spawn();
+    }
+    ImGui::Separator();
+
+    ImGui::Text("%d cars on %d tracks, %d wanderers, %d buildings",
+                spawnedCars, (int)tracks.size(), spawnedWanderers, (int)buildings.size());
+    ImGui::Text("Dynamic tree: %d proxies, height %d", dynamicColliders.ProxyCount(), dynamicColliders.Height());
+    ImGui::Text("Collision queries: %d / step (%llu total)", stepQueries,
+                (unsigned long long)collisionQueries);
+    ImGui::Text("Cars held by traffic: %d", stepBlockedCars);
+    ImGui::Text("Avoidance neighbour queries: %d / step", stepAvoidanceQueries);
+
+    int samples = std::min(stepIndex, TRAFFIC_HISTORY);
+    if (samples > 0) {
+        float sum = 0.0f, worst = 0.0f;
+        for (int i = 0; i < samples; i++) {
+            sum += stepMs[i];
+            worst = std::max(worst, stepMs[i]);
+        }
+        ImGui::Text("Simulation step: avg %.2f  max %.2f ms", sum / samples, worst);
+        ImGui::PlotLines("##step", stepMs, TRAFFIC_HISTORY, stepIndex % TRAFFIC_HISTORY,
+                         nullptr, 0.0f, worst * 1.2f, ImVec2(-1.0f, 50.0f));
+    }
+    if (Profiler::FrameCount() > 0)
+        ImGui::Text("Frame: p50 %.2f  p95 %.2f ms",
+                    Profiler::FrameTimePercentile(0.50f), Profiler::FrameTimePercentile(0.95f));
+
+    ImGui::End();
+}
+
+void P7Scene::OnUnload() {
+    Despawn();
+    objectRenderer.Unload();
+    dynamicBatch.Unload();
+    for (auto tex : loadedTextures) TextureManager::Release(tex);
+    loadedTextures.clear();
+}
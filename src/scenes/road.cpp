@@ -1,5 +1,5 @@
 #include "scenes/road.hpp"
-#include "stb_image.h"
+#include "textures/texture_manager.hpp"
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <iostream>
@@ -13,7 +13,7 @@
 void Road::Load() {
     shader = Shader::LoadShader("resources/shaders/road.vs", "resources/shaders/road.fs");
     GenerateGeometry();
-    texture = LoadTexture("resources/textures/road/road.jpg");
+    texture = TextureManager::Load2D("resources/textures/road/road.jpg");
 }
 
 void Road::GenerateGeometry() {
@@ -101,8 +101,7 @@ void Road::Render(const glm::mat4& view, const glm::mat4& projection) {
     glm::mat4 model = glm::mat4(1.0f);
     glm::mat4 mvp = projection * view * model;
 
-    int mvpLoc = glGetUniformLocation(shader.programID, "uMVP");
-    glUniformMatrix4fv(mvpLoc, 1, GL_FALSE, glm::value_ptr(mvp));
+    shader.SetMat4("uMVP", mvp);
 
     glActiveTexture(GL_TEXTURE0);
     glBindTexture(GL_TEXTURE_2D, texture);
@@ -122,32 +121,8 @@ void Road::Unload() {
     glDeleteVertexArrays(1, &VAO);
     glDeleteBuffers(1, &VBO);
     glDeleteBuffers(1, &EBO);
-    glDeleteTextures(1, &texture);
+    TextureManager::Release(texture);
     shader.Unload();
     VAO = VBO = EBO = texture = 0;
     indexCount = 0;
 }
-
-unsigned int Road::LoadTexture(const std::string& path) {
-    unsigned int textureID;
-    glGenTextures(1, &textureID);
-    glBindTexture(GL_TEXTURE_2D, textureID);
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-    int width, height, nrChannels;
-    unsigned char* data = stbi_load(path.c_str(), &width, &height, &nrChannels, 0);
-    if (data) {
-        GLenum format = (nrChannels == 4) ? GL_RGBA : GL_RGB;
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-    } else {
-        std::cout << "ERROR::ROAD::FAILED_TO_LOAD_TEXTURE: " << path << std::endl;
-    }
-    stbi_image_free(data);
-
-    return textureID;
-}
@@ -1,23 +1,23 @@
 #include "scenes/scene3d.hpp"
 #include "utils/time.hpp"
+#include "utils/profiler.hpp"
+#include "utils/replay.hpp"
 #include "glad.h"
 #include "glfw3.h"
 #include "imgui.h"
 
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <cstdlib>
 
 Scene3D::Scene3D(const Scene3DConfig& cfg)
-    : Scene(cfg.name), camera(cfg.cameraPos), config(cfg) {}
+    : Scene(cfg.name), camera(cfg.cameraPos), config(cfg) {
+    terrain.SetGridSize(cfg.terrainSize);
+    terrain.SetStreaming(cfg.terrainStreamRadius);
+}
 
 void Scene3D::Load() {
-    glEnable(GL_DEPTH_TEST);
-
-    GLFWwindow* window = glfwGetCurrentContext();
-    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
-    cursorLocked = true;
-
-    Time::Reset();
+    srand(seed);
 
     if (config.useSkybox)
         skybox.Load();
@@ -35,6 +35,64 @@ void Scene3D::Load() {
     }
 
     OnLoad();
+
+    // Fill the ring around the starting camera now; later frames only top it up
+    if (config.useTerrain)
+        terrain.Stream(camera.position, true);
+}
+
+void Scene3D::Activate() {
+    glEnable(GL_DEPTH_TEST);
+
+    GLFWwindow* window = glfwGetCurrentContext();
+    glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+    cursorLocked = true;
+
+    // Resume from a clean clock so time spent in other scenes isn't simulated
+    Time::Reset();
+    simulationAccumulator = 0.0;
+    interpolationAlpha = 1.0f;
+}
+
+void Scene3D::Deactivate() {
+    glDisable(GL_DEPTH_TEST);
+    glfwSetInputMode(glfwGetCurrentContext(), GLFW_CURSOR, GLFW_CURSOR_NORMAL);
+    cursorLocked = true;
+}
+
+void Scene3D::Preload() {
+    if (config.useSkybox)
+        skybox.Preload();
+
+    if (config.useTerrain)
+        terrain.Preload(config.terrainGenerator);
+
+    OnPreload();
+}
+
+void Scene3D::CancelPreload() {
+    OnCancelPreload();
+
+    if (config.useSkybox)
+        skybox.CancelPreload();
+
+    if (config.useTerrain)
+        terrain.CancelPreload();
+}
+
+size_t Scene3D::ResidentBytes() const {
+    size_t bytes = 0;
+    if (config.useTerrain)
+        bytes += terrain.MemoryBytes();
+    if (config.useLighting)
+        bytes += lighting.MemoryBytes();
+    return bytes;
+}
+
+uint64_t Scene3D::StateHash() const {
+    uint64_t hash = HashBytes(&camera.position, sizeof(camera.position));
+    hash = HashBytes(&camera.direction, sizeof(camera.direction), hash);
+    return OnHashState(hash);
 }
 
 void Scene3D::Update() {
@@ -57,10 +115,33 @@ void Scene3D::Update() {
         glfwSetInputMode(window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
     }
 
-    if (cursorLocked)
+    // Recording keeps this frame's inputs; playback swaps in the recorded ones
+    bool cameraActive = cursorLocked;
+    Replay::BeginFrame(window, cameraActive);
+
+    if (cameraActive)
         camera.Update(window, Time::deltaTime);
 
+    // Fixed-step simulation, decoupled from the render rate
+    double step = 1.0 / config.simulationHz;
+    simulationAccumulator += Time::deltaTime;
+    int steps = 0;
+    while (simulationAccumulator >= step && steps < config.maxSimulationSteps) {
+        OnFixedUpdate((float)step);
+        if (Replay::Active())
+            Replay::Step(StateHash());
+        simulationAccumulator -= step;
+        steps++;
+    }
+    // Too far behind (hitch or breakpoint): drop the backlog instead of spiralling
+    if (simulationAccumulator >= step)
+        simulationAccumulator = 0.0;
+    interpolationAlpha = (float)(simulationAccumulator / step);
+
     OnUpdate();
+
+    if (config.useTerrain)
+        terrain.Stream(camera.position);
 }
 
 void Scene3D::Render() {
@@ -81,47 +162,43 @@ void Scene3D::Render() {
 
 void Scene3D::RenderUnlit(const glm::mat4& view, const glm::mat4& projection) {
     if (config.useTerrain)
-        terrain.Render(view, projection);
+        terrain.Render(view, projection, camera.position);
 
     OnRender(view, projection);
 }
 
 void Scene3D::RenderLit(const glm::mat4& view, const glm::mat4& projection) {
+    PROFILE_SCOPE("RenderLit");
+
     // 1. Shadow passes
-    lighting.RenderShadowMaps([this](unsigned int shaderID, const glm::mat4& lightMVP) {
-        // Draw terrain
+    lighting.RenderShadowMaps([this](Shader& shader, const glm::mat4& lightMVP) {
+        // Draw terrain, culled to this light's frustum but at the camera's LOD
         if (config.useTerrain) {
-            int loc = glGetUniformLocation(shaderID, "uLightMVP");
-            glm::mat4 model = glm::mat4(1.0f);
-            glm::mat4 mvp = lightMVP * model;
-            glUniformMatrix4fv(loc, 1, GL_FALSE, glm::value_ptr(mvp));
-            terrain.DrawGeometry();
+            shader.SetMat4("uLightMVP", lightMVP);
+            terrain.DrawGeometry(shader, lightMVP, camera.position);
         }
 
         // Let the scene draw its own geometry for shadows
-        OnRenderGeometry(shaderID, lightMVP);
+        OnRenderGeometry(shader, lightMVP);
     });
 
     // 2. Main lit pass
+    PROFILE_SCOPE("Lit pass");
     glUseProgram(litShader.programID);
-    lighting.ApplyToShader(litShader.programID, camera.position);
+    lighting.ApplyToShader(litShader, camera.position);
 
-    glUniformMatrix4fv(glGetUniformLocation(litShader.programID, "uView"),
-                       1, GL_FALSE, glm::value_ptr(view));
-    glUniformMatrix4fv(glGetUniformLocation(litShader.programID, "uProjection"),
-                       1, GL_FALSE, glm::value_ptr(projection));
+    litShader.SetMat4("uView", view);
+    litShader.SetMat4("uProjection", projection);
+
+    // Albedo always comes from unit 0; scenes only bind the texture per object
+    litShader.SetInt("uTexture", 0);
 
     // Draw terrain with lit shader
     if (config.useTerrain) {
-        glm::mat4 model = glm::mat4(1.0f);
-        glUniformMatrix4fv(glGetUniformLocation(litShader.programID, "uModel"),
-                           1, GL_FALSE, glm::value_ptr(model));
-
         glActiveTexture(GL_TEXTURE0);
         glBindTexture(GL_TEXTURE_2D, terrain.GetTexture());
-        glUniform1i(glGetUniformLocation(litShader.programID, "uTexture"), 0);
 
-        terrain.DrawGeometry();
+        terrain.DrawGeometry(litShader, projection * view, camera.position);
     }
 
     // Let scene render its lit objects
@@ -141,10 +218,6 @@ void Scene3D::Unload() {
         lighting.Unload();
         litShader.Unload();
     }
-
-    glDisable(GL_DEPTH_TEST);
-    glfwSetInputMode(glfwGetCurrentContext(), GLFW_CURSOR, GLFW_CURSOR_NORMAL);
-    cursorLocked = true;
 }
 
 void Scene3D::RenderLightingDebugUI() {
@@ -1,18 +1,79 @@
 #include "scenes/scene_manager.hpp"
+#include "textures/texture_manager.hpp"
 #include "imgui.h"
+#include <algorithm>
 
 void SceneManager::RegisterScene(Scene* scene) {
     scenes.push_back(scene);
 }
 
 void SceneManager::SwitchTo(int index) {
-    if (activeIndex >= 0 && scenes[activeIndex]->loaded) {
-        scenes[activeIndex]->Unload();
-        scenes[activeIndex]->loaded = false;
-    }
+    if (index == activeIndex) return;
+
+    if (activeIndex >= 0)
+        scenes[activeIndex]->Deactivate();
+
+    // Resident scenes come back without a reload
     activeIndex = index;
-    scenes[activeIndex]->Load();
-    scenes[activeIndex]->loaded = true;
+    Scene* scene = scenes[activeIndex];
+    if (!scene->loaded) {
+        scene->Load();
+        scene->loaded = true;
+        scene->preloaded = false;
+        if (preloadIndex == index) preloadIndex = -1;
+    }
+    scene->Activate();
+    Touch(index);
+    EnforceBudget();
+
+    // Only now drop textures the old scene used and the new one didn't pick up again
+    TextureManager::CollectUnused();
+
+    if (preloadNeighbours && !scenes.empty())
+        Preload((index + 1) % (int)scenes.size());
+}
+
+void SceneManager::Preload(int index) {
+    Scene* scene = scenes[index];
+    if (scene->loaded || scene->preloaded) return;
+
+    // Only one speculative preload at a time
+    if (preloadIndex >= 0 && scenes[preloadIndex]->preloaded) {
+        scenes[preloadIndex]->CancelPreload();
+        scenes[preloadIndex]->preloaded = false;
+    }
+
+    scene->Preload();
+    scene->preloaded = true;
+    preloadIndex = index;
+}
+
+void SceneManager::Touch(int index) {
+    recentlyUsed.erase(std::remove(recentlyUsed.begin(), recentlyUsed.end(), index), recentlyUsed.end());
+    recentlyUsed.push_back(index);
+}
+
+void SceneManager::UnloadScene(int index) {
+    scenes[index]->Unload();
+    scenes[index]->loaded = false;
+    recentlyUsed.erase(std::remove(recentlyUsed.begin(), recentlyUsed.end(), index), recentlyUsed.end());
+}
+
+size_t SceneManager::ResidentBytes() const {
+    size_t bytes = 0;
+    for (int index : recentlyUsed)
+        bytes += scenes[index]->ResidentBytes();
+    return bytes;
+}
+
+void SceneManager::EnforceBudget() {
+    // Evict least recently used first; the active scene always stays
+    while (ResidentBytes() > residencyBudgetBytes) {
+        auto victim = std::find_if(recentlyUsed.begin(), recentlyUsed.end(),
+                                   [this](int index) { return index != activeIndex; });
+        if (victim == recentlyUsed.end()) break;
+        UnloadScene(*victim);
+    }
 }
 
 void SceneManager::Update() {
@@ -44,6 +105,9 @@ void SceneManager::RenderTabs() {
                 }
                 ImGui::EndTabItem();
             }
+            // Hovering a tab is a good hint it's about to be clicked
+            if (preloadNeighbours && ImGui::IsItemHovered())
+                Preload(i);
         }
         ImGui::EndTabBar();
     }
@@ -52,10 +116,20 @@ void SceneManager::RenderTabs() {
 }
 
 void SceneManager::UnloadAll() {
+    if (activeIndex >= 0)
+        scenes[activeIndex]->Deactivate();
+
     for (auto* scene : scenes) {
         if (scene->loaded) {
             scene->Unload();
             scene->loaded = false;
+        } else if (scene->preloaded) {
+            scene->CancelPreload();
         }
+        scene->preloaded = false;
     }
+    activeIndex = -1;
+    preloadIndex = -1;
+    recentlyUsed.clear();
+    TextureManager::CollectUnused();
 }
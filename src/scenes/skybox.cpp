@@ -1,5 +1,5 @@
 #include "scenes/skybox.hpp"
-#include "stb_image.h"
+#include "textures/texture_manager.hpp"
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <iostream>
@@ -46,8 +46,25 @@ void Skybox::Load() {
 
     glBindVertexArray(0);
 
-    // Load cubemap faces
-    cubemapTexture = LoadCubemap();
+    // Load cubemap faces (already requested if the scene was preloaded)
+    Preload();
+}
+
+void Skybox::Preload() {
+    if (cubemapTexture != 0) return;
+    cubemapTexture = TextureManager::LoadCubemap({
+        "resources/textures/skybox/right.png",
+        "resources/textures/skybox/left.png",
+        "resources/textures/skybox/top.png",
+        "resources/textures/skybox/bottom.png",
+        "resources/textures/skybox/front.png",
+        "resources/textures/skybox/back.png"
+    });
+}
+
+void Skybox::CancelPreload() {
+    TextureManager::Release(cubemapTexture);
+    cubemapTexture = 0;
 }
 
 void Skybox::Render(const glm::mat4& view, const glm::mat4& projection) {
@@ -59,11 +76,8 @@ void Skybox::Render(const glm::mat4& view, const glm::mat4& projection) {
     // Remove translation so skybox stays centered on camera
     glm::mat4 skyboxView = glm::mat4(glm::mat3(view));
 
-    int viewLoc = glGetUniformLocation(shader.programID, "uView");
-    glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(skyboxView));
-
-    int projLoc = glGetUniformLocation(shader.programID, "uProjection");
-    glUniformMatrix4fv(projLoc, 1, GL_FALSE, glm::value_ptr(projection));
+    shader.SetMat4("uView", skyboxView);
+    shader.SetMat4("uProjection", projection);
 
     glBindVertexArray(VAO);
     glActiveTexture(GL_TEXTURE0);
@@ -78,44 +92,7 @@ void Skybox::Unload() {
     glDeleteVertexArrays(1, &VAO);
     glDeleteBuffers(1, &VBO);
     glDeleteBuffers(1, &EBO);
-    glDeleteTextures(1, &cubemapTexture);
+    TextureManager::Release(cubemapTexture);
     shader.Unload();
     VAO = VBO = EBO = cubemapTexture = 0;
 }
-
-unsigned int Skybox::LoadCubemap() {
-    // Load all 6 faces
-    std::string faces[] = {
-        "resources/textures/skybox/right.png",
-        "resources/textures/skybox/left.png",
-        "resources/textures/skybox/top.png",
-        "resources/textures/skybox/bottom.png",
-        "resources/textures/skybox/front.png",
-        "resources/textures/skybox/back.png"
-    };
-
-    unsigned int textureID;
-    glGenTextures(1, &textureID);
-    glBindTexture(GL_TEXTURE_CUBE_MAP, textureID);
-
-    int width, height, nrChannels;
-    for (int i = 0; i < 6; i++) {
-        unsigned char* data = stbi_load(faces[i].c_str(), &width, &height, &nrChannels, 0);
-        if (data) {
-            GLenum format = (nrChannels == 4) ? GL_RGBA : GL_RGB;
-            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i,
-                         0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        } else {
-            std::cout << "ERROR::SKYBOX::FAILED_TO_LOAD: " << faces[i] << std::endl;
-        }
-        stbi_image_free(data);
-    }
-
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
-
-    return textureID;
-}
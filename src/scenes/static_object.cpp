@@ -1,7 +1,7 @@
 #include "scenes/static_object.hpp"
-#include "stb_image.h"
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <algorithm>
 #include <iostream>
 
 void StaticObjectRenderer::Load() {
@@ -9,6 +9,23 @@ void StaticObjectRenderer::Load() {
     CreateCubeMesh();
 }
 
+void StaticObjectRenderer::SetupCubeAttributes() {
+    glBindBuffer(GL_ARRAY_BUFFER, cubeVBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, cubeEBO);
+
+    // Position: layout 0
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
+    glEnableVertexAttribArray(0);
+
+    // Normal: layout 1
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
+
+    // UV: layout 2
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
+    glEnableVertexAttribArray(2);
+}
+
 void StaticObjectRenderer::CreateCubeMesh() {
     // Textured unit cube: 24 vertices (4 per face for correct UVs)
     // Each vertex: x, y, z, nx, ny, nz, u, v
@@ -65,40 +82,50 @@ void StaticObjectRenderer::CreateCubeMesh() {
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, cubeEBO);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
 
-    // Position: layout 0
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
-    glEnableVertexAttribArray(0);
-
-    // Normal: layout 1
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
+    SetupCubeAttributes();
 
-    // UV: layout 2
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
-    glEnableVertexAttribArray(2);
+    // Instanced VAO: the matrix pointers are re-aimed per draw, only the layout is fixed here
+    glGenVertexArrays(1, &instanceVAO);
+    glBindVertexArray(instanceVAO);
+    SetupCubeAttributes();
+    for (int c = 0; c < 4; c++) {
+        glEnableVertexAttribArray(INSTANCE_MODEL_LOCATION + c);
+        glVertexAttribDivisor(INSTANCE_MODEL_LOCATION + c, 1);
+    }
 
     glBindVertexArray(0);
 }
 
-void StaticObjectRenderer::Render(const std::vector<ObjectInstance>& objects,
+void StaticObjectRenderer::Render(const InstanceBatch& batch,
                                    const glm::mat4& view, const glm::mat4& projection) {
     glUseProgram(shader.programID);
-    glBindVertexArray(cubeVAO);
-
-    for (const auto& obj : objects) {
-        glm::mat4 model = ModelMatrixFromObject(obj);
-
-        glm::mat4 mvp = projection * view * model;
-        int mvpLoc = glGetUniformLocation(shader.programID, "uMVP");
-        glUniformMatrix4fv(mvpLoc, 1, GL_FALSE, glm::value_ptr(mvp));
-
-        glActiveTexture(GL_TEXTURE0);
-        glBindTexture(GL_TEXTURE_2D, obj.textureID);
+    shader.SetMat4("uMVP", projection * view);
+    DrawInstanced(shader, batch);
+}
 
-        glDrawElements(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0);
+void StaticObjectRenderer::DrawInstanced(Shader& activeShader, const InstanceBatch& batch, bool bindTextures) {
+    if (batch.Count() == 0) return;
+
+    activeShader.SetInt("uInstanced", 1);
+    glBindVertexArray(instanceVAO);
+    glBindBuffer(GL_ARRAY_BUFFER, batch.Buffer());
+
+    // GL 3.3 has no base instance, so point the matrix attributes at each group's slice
+    for (const auto& group : batch.Groups()) {
+        size_t offset = (size_t)group.first * sizeof(glm::mat4);
+        for (int c = 0; c < 4; c++)
+            glVertexAttribPointer(INSTANCE_MODEL_LOCATION + c, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4),
+                                  (void*)(offset + c * sizeof(glm::vec4)));
+
+        if (bindTextures) {
+            glActiveTexture(GL_TEXTURE0);
+            glBindTexture(GL_TEXTURE_2D, group.textureID);
+        }
+        glDrawElementsInstanced(GL_TRIANGLES, 36, GL_UNSIGNED_INT, 0, group.count);
     }
 
     glBindVertexArray(0);
+    activeShader.SetInt("uInstanced", 0);
 }
 
 void StaticObjectRenderer::BindAndDraw() {
@@ -109,35 +136,70 @@ void StaticObjectRenderer::BindAndDraw() {
 
 void StaticObjectRenderer::Unload() {
     glDeleteVertexArrays(1, &cubeVAO);
+    glDeleteVertexArrays(1, &instanceVAO);
     glDeleteBuffers(1, &cubeVBO);
     glDeleteBuffers(1, &cubeEBO);
     shader.Unload();
-    cubeVAO = cubeVBO = cubeEBO = 0;
+    cubeVAO = cubeVBO = cubeEBO = instanceVAO = 0;
+}
+
+void InstanceBatch::Clear() {
+    entries.clear();
+    matrices.clear();
+    groups.clear();
+}
+
+void InstanceBatch::Add(const glm::mat4& model, unsigned int textureID) {
+    entries.push_back({ model, textureID });
 }
 
-unsigned int StaticObjectRenderer::LoadTexture(const std::string& path) {
-    unsigned int textureID;
-    glGenTextures(1, &textureID);
-    glBindTexture(GL_TEXTURE_2D, textureID);
-
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-    int width, height, nrChannels;
-    unsigned char* data = stbi_load(path.c_str(), &width, &height, &nrChannels, 0);
-    if (data) {
-        GLenum format = (nrChannels == 4) ? GL_RGBA : GL_RGB;
-        // RGB rows may not be 4-byte aligned — tell OpenGL to expect tight packing
-        if (nrChannels == 3) glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        if (nrChannels == 3) glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
-        glGenerateMipmap(GL_TEXTURE_2D);
-    } else {
-        std::cout << "ERROR::STATIC_OBJECT::FAILED_TO_LOAD_TEXTURE: " << path << std::endl;
+void InstanceBatch::Add(const std::vector<ObjectInstance>& objects, const TransformCache& transforms) {
+    entries.reserve(entries.size() + objects.size());
+    for (int i = 0; i < (int)objects.size(); i++)
+        entries.push_back({ transforms[i], objects[i].textureID });
+}
+
+void InstanceBatch::Upload() {
+    std::stable_sort(entries.begin(), entries.end(),
+                     [](const Entry& a, const Entry& b) { return a.textureID < b.textureID; });
+
+    matrices.clear();
+    groups.clear();
+    for (const auto& e : entries) {
+        if (groups.empty() || groups.back().textureID != e.textureID)
+            groups.push_back({ e.textureID, (int)matrices.size(), 0 });
+        groups.back().count++;
+        matrices.push_back({ e.model });
+    }
+    entries.clear();
+
+    if (instanceVBO == 0) glGenBuffers(1, &instanceVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, instanceVBO);
+    int count = (int)matrices.size();
+    if (count > capacity) {
+        capacity = count;
+        glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(glm::mat4), matrices.data(), GL_DYNAMIC_DRAW);
+    } else if (count > 0) {
+        // Orphan so a per-frame rebuild doesn't wait on draws still reading the old contents
+        glBufferData(GL_ARRAY_BUFFER, capacity * sizeof(glm::mat4), nullptr, GL_DYNAMIC_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, count * sizeof(glm::mat4), matrices.data());
     }
-    stbi_image_free(data);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void InstanceBatch::Unload() {
+    if (instanceVBO) glDeleteBuffers(1, &instanceVBO);
+    instanceVBO = 0;
+    capacity = 0;
+    Clear();
+}
+
+void TransformCache::Build(const std::vector<ObjectInstance>& objects) {
+    matrices.resize(objects.size());
+    for (int i = 0; i < (int)objects.size(); i++)
+        matrices[i].m = ModelMatrixFromObject(objects[i]);
+}
 
-    return textureID;
+void TransformCache::Clear() {
+    matrices.clear();
 }
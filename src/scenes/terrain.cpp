@@ -1,154 +1,496 @@
 #include "scenes/terrain.hpp"
-#include "stb_image.h"
+#include "textures/texture_manager.hpp"
+#include "utils/thread_pool.hpp"
 #include <glm/gtc/matrix_transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
 #include <iostream>
 #include <vector>
+#include <algorithm>
+#include <cfloat>
 #include <cmath>
 
+// Heightfield rows per parallel chunk when sampling the generator
+#define TERRAIN_ROW_GRAIN 16
+
+// Tile generation gets its own threads, so it never queues behind (or delays) simulation work
+static ThreadPool& StreamPool() {
+    static ThreadPool pool(std::min(ThreadPool::DefaultThreadCount(), TERRAIN_STREAM_THREADS));
+    return pool;
+}
+
+// R32F heightmap, filtered so the morphed vertices between samples interpolate smoothly
+static unsigned int CreateHeightmap(int samples, const float* heights) {
+    unsigned int heightmap;
+    glGenTextures(1, &heightmap);
+    glBindTexture(GL_TEXTURE_2D, heightmap);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, samples, samples, 0, GL_RED, GL_FLOAT, heights);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return heightmap;
+}
+
+void Terrain::Preload(TerrainGenerator* generator) {
+    // Streamed tiles are generated around the camera once the scene is running
+    if (streamRadius <= 0 && !pendingHeightfield.valid()) {
+        const TerrainGenerator* source = generator ? generator : &flatGenerator;
+        int size = gridSize;
+        // Promise-backed, so dropping the future never blocks (a std::async future would)
+        auto promise = std::make_shared<std::promise<TerrainHeightfield>>();
+        auto cancelled = std::make_shared<std::atomic<bool>>(false);
+        pendingHeightfield = promise->get_future();
+        preloadCancelled = cancelled;
+        StreamPool().Submit([promise, cancelled, source, size]() {
+            TerrainHeightfield field;
+            if (!cancelled->load())
+                BuildHeightfield(source, glm::vec2(-size / 2.0f), size, &ThreadPool::Shared(), field);
+            promise->set_value(std::move(field));
+        });
+    }
+    if (texture == 0)
+        texture = TextureManager::Load2D("resources/textures/terrain/terrain.jpg");
+}
+
+// Runs on the GL thread when a hovered tab is left, so it must not wait for the build:
+// a job that hasn't started skips its work, one that has finishes into a future nobody reads
+void Terrain::CancelPreload() {
+    if (preloadCancelled) preloadCancelled->store(true);
+    preloadCancelled.reset();
+    pendingHeightfield = std::future<TerrainHeightfield>();
+    TextureManager::Release(texture);
+    texture = 0;
+}
+
 void Terrain::Load() {
-    FlatGenerator flat(1.0f);
-    Load(&flat);
+    Load(&flatGenerator);
 }
 
 void Terrain::Load(TerrainGenerator* generator) {
     shader = Shader::LoadShader("resources/shaders/terrain.vs", "resources/shaders/terrain.fs");
-    GenerateMesh(generator);
-    texture = LoadTexture("resources/textures/terrain/terrain.jpg");
+    CreatePatch();
+    if (texture == 0)
+        texture = TextureManager::Load2D("resources/textures/terrain/terrain.jpg");
+
+    if (streamRadius > 0) {
+        LoadStreaming(generator);
+        return;
+    }
+
+    // Use the preloaded heightfield if there is one (waits only if the worker is still running)
+    TerrainHeightfield field;
+    if (pendingHeightfield.valid())
+        field = pendingHeightfield.get();
+    else
+        BuildHeightfield(generator, glm::vec2(-gridSize / 2.0f), gridSize, &ThreadPool::Shared(), field);
+    preloadCancelled.reset();
+
+    tiles.resize(1);
+    UploadHeightfield(tiles[0], field);
+    tiles[0].state = TileState::Resident;
 }
 
-void Terrain::GenerateMesh(TerrainGenerator* generator) {
-    std::vector<float> vertices;
-    std::vector<unsigned int> indices;
+// Pure CPU work, safe to run off the GL thread as long as the generator is read-only.
+// Every sample is taken exactly once, a band of rows per GetGrid call (bands run on `pool` if
+// given); the quadtree ranges are then reduced from the samples. Reuses the field's buffers,
+// so refilling a field of the same size doesn't allocate.
+void Terrain::BuildHeightfield(const TerrainGenerator* generator, glm::vec2 origin, int size,
+                               ThreadPool* pool, TerrainHeightfield& field) {
+    int n = size + 3;
+    field.origin = origin;
+    field.size = size;
+    field.samples = n;
+    field.heights.resize((size_t)n * n);
 
-    for (int z = 0; z <= gridSize; z++) {
-        for (int x = 0; x <= gridSize; x++) {
-            float xPos = (float)x - gridSize / 2.0f;
-            float zPos = (float)z - gridSize / 2.0f;
-            float yPos = generator->GetHeight(xPos, zPos);
-
-            float u = (float)x / gridSize;
-            float v = (float)z / gridSize;
-
-            // Position
-            vertices.push_back(xPos);
-            vertices.push_back(yPos);
-            vertices.push_back(zPos);
-
-            // Normal from cross product of neighbors
-            float hL = generator->GetHeight(xPos - 1, zPos);
-            float hR = generator->GetHeight(xPos + 1, zPos);
-            float hD = generator->GetHeight(xPos, zPos - 1);
-            float hU = generator->GetHeight(xPos, zPos + 1);
-            glm::vec3 normal = glm::normalize(glm::vec3(hL - hR, 2.0f, hD - hU));
-            vertices.push_back(normal.x);
-            vertices.push_back(normal.y);
-            vertices.push_back(normal.z);
-
-            // UV
-            vertices.push_back(u);
-            vertices.push_back(v);
+    // Sample (x, z) lies at origin + (x - 1, z - 1): the border ring sits just outside the field
+    auto sampleRows = [&](int begin, int end) {
+        generator->GetGrid(origin.x - 1.0f, origin.y + (float)(begin - 1), 1.0f, n, end - begin,
+                           field.heights.data() + (size_t)begin * n);
+    };
+    if (pool) pool->ParallelFor(n, TERRAIN_ROW_GRAIN, sampleRows);
+    else sampleRows(0, n);
+
+    int side = (size + TERRAIN_PATCH_RES - 1) / TERRAIN_PATCH_RES;
+    int levels = 1;
+    for (int s = side; s > 1; s = (s + 1) / 2) levels++;
+    field.levelSide.resize(levels);
+    field.ranges.resize(levels);
+
+    // Leaves share their border samples with their neighbours
+    field.levelSide[0] = side;
+    std::vector<glm::vec2>& leaves = field.ranges[0];
+    leaves.resize((size_t)side * side);
+    auto leafRows = [&](int begin, int end) {
+        for (int nz = begin; nz < end; nz++) {
+            for (int nx = 0; nx < side; nx++) {
+                int x0 = nx * TERRAIN_PATCH_RES, x1 = std::min(x0 + TERRAIN_PATCH_RES, size);
+                int z0 = nz * TERRAIN_PATCH_RES, z1 = std::min(z0 + TERRAIN_PATCH_RES, size);
+                glm::vec2 range(FLT_MAX, -FLT_MAX);
+                for (int z = z0 + 1; z <= z1 + 1; z++) {
+                    for (int x = x0 + 1; x <= x1 + 1; x++) {
+                        float h = field.heights[(size_t)z * n + x];
+                        range.x = std::min(range.x, h);
+                        range.y = std::max(range.y, h);
+                    }
+                }
+                leaves[(size_t)nz * side + nx] = range;
+            }
+        }
+    };
+    if (pool) pool->ParallelFor(side, 1, leafRows);
+    else leafRows(0, side);
+
+    for (int level = 1; level < levels; level++) {
+        int childSide = field.levelSide[level - 1];
+        int parentSide = (childSide + 1) / 2;
+        const std::vector<glm::vec2>& children = field.ranges[level - 1];
+        std::vector<glm::vec2>& parents = field.ranges[level];
+        parents.assign((size_t)parentSide * parentSide, glm::vec2(FLT_MAX, -FLT_MAX));
+        for (int z = 0; z < childSide; z++) {
+            for (int x = 0; x < childSide; x++) {
+                const glm::vec2& child = children[(size_t)z * childSide + x];
+                glm::vec2& parent = parents[(size_t)(z / 2) * parentSide + x / 2];
+                parent.x = std::min(parent.x, child.x);
+                parent.y = std::max(parent.y, child.y);
+            }
         }
+        field.levelSide[level] = parentSide;
     }
+}
+
+// Takes the field's quadtree by swapping, so the field keeps the tile's old buffers for reuse
+void Terrain::UploadHeightfield(Tile& tile, TerrainHeightfield& field) {
+    tile.origin = field.origin;
+    tile.size = field.size;
+    std::swap(tile.levelSide, field.levelSide);
+    std::swap(tile.ranges, field.ranges);
 
-    for (int z = 0; z < gridSize; z++) {
-        for (int x = 0; x < gridSize; x++) {
-            int topLeft = z * (gridSize + 1) + x;
-            int topRight = topLeft + 1;
-            int bottomLeft = (z + 1) * (gridSize + 1) + x;
-            int bottomRight = bottomLeft + 1;
+    if (tile.heightmap != 0 && tile.samples == field.samples) {
+        glBindTexture(GL_TEXTURE_2D, tile.heightmap);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, field.samples, field.samples, GL_RED, GL_FLOAT, field.heights.data());
+        glBindTexture(GL_TEXTURE_2D, 0);
+    } else {
+        glDeleteTextures(1, &tile.heightmap);
+        tile.heightmap = CreateHeightmap(field.samples, field.heights.data());
+    }
+    tile.samples = field.samples;
+}
+
+// Streaming
+
+void Terrain::LoadStreaming(const TerrainGenerator* generator) {
+    streamGenerator = generator;
+
+    // Every tile of the ring, plus one slot per job that may still be finishing a tile the
+    // ring has already left, so the ring can always be filled
+    int ring = 2 * streamRadius + 1;
+    int slots = ring * ring + TERRAIN_STREAM_MAX_JOBS;
+    int samples = TERRAIN_TILE_SIZE + 3;
+
+    tiles.resize(slots);
+    staging.resize(slots);
+    for (int i = 0; i < slots; i++) {
+        tiles[i].heightmap = CreateHeightmap(samples, nullptr);
+        tiles[i].samples = samples;
+        staging[i].heights.resize((size_t)samples * samples);
+    }
+
+    ringOffsets.clear();
+    for (int z = -streamRadius; z <= streamRadius; z++)
+        for (int x = -streamRadius; x <= streamRadius; x++)
+            ringOffsets.push_back(glm::ivec2(x, z));
+    std::stable_sort(ringOffsets.begin(), ringOffsets.end(), [](const glm::ivec2& a, const glm::ivec2& b) {
+        return a.x * a.x + a.y * a.y < b.x * b.x + b.y * b.y;
+    });
+}
+
+void Terrain::QueueTile(int index, glm::ivec2 coord) {
+    Tile& tile = tiles[index];
+    tile.state = TileState::Generating;
+    tile.coord = coord;
+    tile.wanted = true;
+    streamJobs++;
+
+    const TerrainGenerator* generator = streamGenerator;
+    glm::vec2 origin = glm::vec2(coord) * (float)TERRAIN_TILE_SIZE;
+    TerrainHeightfield* field = &staging[index];
+    StreamPool().Submit([this, index, generator, origin, field]() {
+        BuildHeightfield(generator, origin, TERRAIN_TILE_SIZE, nullptr, *field);
+        std::lock_guard<std::mutex> lock(streamMutex);
+        streamFinished.push_back(index);
+    });
+}
+
+void Terrain::Stream(const glm::vec3& center, bool blocking) {
+    if (streamRadius <= 0 || tiles.empty()) return;
+
+    glm::ivec2 centerTile((int)std::floor(center.x / TERRAIN_TILE_SIZE), (int)std::floor(center.z / TERRAIN_TILE_SIZE));
+    while (true) {
+        // Upload finished tiles; ones the ring has left in the meantime just free their slot
+        int uploads = 0;
+        while (blocking || uploads < TERRAIN_STREAM_UPLOADS_PER_FRAME) {
+            int index;
+            {
+                std::lock_guard<std::mutex> lock(streamMutex);
+                if (streamFinished.empty()) break;
+                index = streamFinished.front();
+                streamFinished.pop_front();
+            }
+            streamJobs--;
+
+            Tile& tile = tiles[index];
+            if (!tile.wanted) {
+                tile.state = TileState::Empty;
+                continue;
+            }
+            UploadHeightfield(tile, staging[index]);
+            tile.state = TileState::Resident;
+            uploads++;
+        }
+
+        // Evict tiles outside the ring (Chebyshev distance in tiles)
+        for (Tile& tile : tiles) {
+            if (tile.state == TileState::Empty) continue;
+            int distance = std::max(std::abs(tile.coord.x - centerTile.x), std::abs(tile.coord.y - centerTile.y));
+            bool inRing = distance <= streamRadius;
+            if (tile.state == TileState::Resident && !inRing) tile.state = TileState::Empty;
+            else if (tile.state == TileState::Generating) tile.wanted = inRing;
+        }
+
+        // Queue missing tiles, nearest first
+        for (const glm::ivec2& offset : ringOffsets) {
+            if (streamJobs >= TERRAIN_STREAM_MAX_JOBS) break;
+            glm::ivec2 coord = centerTile + offset;
+            bool present = false;
+            int freeSlot = -1;
+            for (int i = 0; i < (int)tiles.size(); i++) {
+                if (tiles[i].state == TileState::Empty) {
+                    if (freeSlot < 0) freeSlot = i;
+                } else if (tiles[i].coord == coord) {
+                    present = true;
+                    break;
+                }
+            }
+            if (present) continue;
+            if (freeSlot < 0) break;
+            QueueTile(freeSlot, coord);
+        }
+
+        if (!blocking || streamJobs == 0) break;
+        StreamPool().Wait();
+    }
+}
 
-            indices.push_back(topLeft);
-            indices.push_back(bottomLeft);
-            indices.push_back(topRight);
+int Terrain::ResidentTileCount() const {
+    int count = 0;
+    for (const Tile& tile : tiles)
+        if (tile.state == TileState::Resident) count++;
+    return count;
+}
 
-            indices.push_back(topRight);
-            indices.push_back(bottomLeft);
-            indices.push_back(bottomRight);
+// One (TERRAIN_PATCH_RES + 1)^2 grid of integer coordinates, indexed quadrant by quadrant so a
+// node can draw any subset of its four quadrants as contiguous index ranges
+void Terrain::CreatePatch() {
+    const int res = TERRAIN_PATCH_RES, half = TERRAIN_PATCH_RES / 2;
+    std::vector<float> vertices;
+    vertices.reserve((size_t)(res + 1) * (res + 1) * 3);
+    for (int z = 0; z <= res; z++) {
+        for (int x = 0; x <= res; x++) {
+            vertices.push_back((float)x);
+            vertices.push_back(0.0f);
+            vertices.push_back((float)z);
         }
     }
 
-    indexCount = (int)indices.size();
+    std::vector<unsigned int> indices;
+    indices.reserve((size_t)res * res * 6);
+    for (int q = 0; q < 4; q++) {
+        int qx = (q & 1) * half, qz = (q >> 1) * half;
+        for (int z = qz; z < qz + half; z++) {
+            for (int x = qx; x < qx + half; x++) {
+                unsigned int topLeft = z * (res + 1) + x;
+                unsigned int topRight = topLeft + 1;
+                unsigned int bottomLeft = (z + 1) * (res + 1) + x;
+                unsigned int bottomRight = bottomLeft + 1;
+
+                indices.push_back(topLeft);
+                indices.push_back(bottomLeft);
+                indices.push_back(topRight);
+
+                indices.push_back(topRight);
+                indices.push_back(bottomLeft);
+                indices.push_back(bottomRight);
+            }
+        }
+    }
+    patchIndexCount = (int)indices.size();
 
-    glGenVertexArrays(1, &VAO);
-    glBindVertexArray(VAO);
+    glGenVertexArrays(1, &patchVAO);
+    glBindVertexArray(patchVAO);
 
-    glGenBuffers(1, &VBO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
+    glGenBuffers(1, &patchVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, patchVBO);
     glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
 
-    glGenBuffers(1, &EBO);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+    glGenBuffers(1, &patchEBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, patchEBO);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), indices.data(), GL_STATIC_DRAW);
 
-    // Position: layout 0
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)0);
+    // Grid position: layout 0 (normals and UVs come from the heightmap)
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
     glEnableVertexAttribArray(0);
 
-    // Normal: layout 1
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
+    glBindVertexArray(0);
+}
 
-    // UV: layout 2
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, 8 * sizeof(float), (void*)(6 * sizeof(float)));
-    glEnableVertexAttribArray(2);
+// Min/max ranges of every quadtree level over a field of the given size
+static size_t QuadtreeBytes(int size) {
+    size_t nodes = 0;
+    for (int side = (size + TERRAIN_PATCH_RES - 1) / TERRAIN_PATCH_RES;; side = (side + 1) / 2) {
+        nodes += (size_t)side * side;
+        if (side <= 1) break;
+    }
+    return nodes * sizeof(glm::vec2);
+}
 
-    glBindVertexArray(0);
+// Computed from the slot sizes rather than the buffers: stream jobs resize their staging
+// field while this runs on the GL thread (e.g. from SceneManager's budget check)
+size_t Terrain::MemoryBytes() const {
+    size_t bytes = 0;
+    if (patchVAO)
+        bytes += (size_t)(TERRAIN_PATCH_RES + 1) * (TERRAIN_PATCH_RES + 1) * 3 * sizeof(float)
+               + (size_t)patchIndexCount * sizeof(unsigned int);
+    for (const Tile& tile : tiles)
+        if (tile.heightmap) bytes += (size_t)tile.samples * tile.samples * sizeof(float) + QuadtreeBytes(tile.size);
+    if (!staging.empty()) {
+        size_t samples = TERRAIN_TILE_SIZE + 3;
+        bytes += staging.size() * (samples * samples * sizeof(float) + QuadtreeBytes(TERRAIN_TILE_SIZE));
+    }
+    return bytes;
 }
 
-void Terrain::Render(const glm::mat4& view, const glm::mat4& projection) {
-    glUseProgram(shader.programID);
+// Quadtree selection
 
-    glm::mat4 model = glm::mat4(1.0f);
-    glm::mat4 mvp = projection * view * model;
+AABB Terrain::NodeBounds(const Tile& tile, int level, int x, int z) const {
+    float size = (float)(TERRAIN_PATCH_RES << level);
+    glm::vec2 end = tile.origin + glm::vec2((float)tile.size);
+    const glm::vec2& range = tile.ranges[level][(size_t)z * tile.levelSide[level] + x];
+    return { glm::vec3(tile.origin.x + x * size, range.x, tile.origin.y + z * size),
+             glm::vec3(std::min(tile.origin.x + (x + 1) * size, end.x), range.y,
+                       std::min(tile.origin.y + (z + 1) * size, end.y)) };
+}
 
-    int mvpLoc = glGetUniformLocation(shader.programID, "uMVP");
-    glUniformMatrix4fv(mvpLoc, 1, GL_FALSE, glm::value_ptr(mvp));
+static bool SphereIntersects(const AABB& box, const glm::vec3& center, float radius) {
+    glm::vec3 d = center - glm::clamp(center, box.min, box.max);
+    return glm::dot(d, d) <= radius * radius;
+}
 
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, texture);
+// Returns false if the node is beyond its level's range, leaving its area to the parent
+bool Terrain::SelectNode(const Tile& tile, int level, int x, int z, const Frustum& frustum,
+                         const glm::vec3& lodOrigin, bool root) {
+    AABB box = NodeBounds(tile, level, x, z);
+    if (!root && !SphereIntersects(box, lodOrigin, LodRange(level))) return false;
+    if (!frustum.Intersects(box)) return true;
 
-    glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
+    if (level == 0 || !SphereIntersects(box, lodOrigin, LodRange(level - 1))) {
+        selection.push_back({ level, x, z, 0xF });
+        return true;
+    }
+
+    // Children in range draw themselves; the rest of the node is drawn here, quadrant by quadrant
+    int quadrants = 0;
+    int childSide = tile.levelSide[level - 1];
+    for (int q = 0; q < 4; q++) {
+        int cx = x * 2 + (q & 1), cz = z * 2 + (q >> 1);
+        if (cx >= childSide || cz >= childSide) continue;  // past the terrain edge
+        if (!SelectNode(tile, level - 1, cx, cz, frustum, lodOrigin, false) &&
+            frustum.Intersects(NodeBounds(tile, level - 1, cx, cz)))
+            quadrants |= 1 << q;
+    }
+    if (quadrants) selection.push_back({ level, x, z, quadrants });
+    return true;
 }
 
-void Terrain::DrawGeometry() {
-    glBindVertexArray(VAO);
-    glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0);
+void Terrain::DrawGeometry(Shader& activeShader, const glm::mat4& viewProjection, const glm::vec3& lodOrigin) {
+    lastNodeCount = 0;
+    if (patchVAO == 0) return;
+
+    Frustum frustum = Frustum::FromMatrix(viewProjection);
+    activeShader.SetInt("uTerrain", 1);
+    activeShader.SetInt("uHeightmap", TERRAIN_HEIGHTMAP_UNIT);
+    activeShader.SetVec3("uLodOrigin", lodOrigin);
+
+    glBindVertexArray(patchVAO);
+    glActiveTexture(GL_TEXTURE0 + TERRAIN_HEIGHTMAP_UNIT);
+    int quarter = patchIndexCount / 4;
+    for (const Tile& tile : tiles) {
+        if (tile.state != TileState::Resident) continue;
+
+        selection.clear();
+        SelectNode(tile, (int)tile.levelSide.size() - 1, 0, 0, frustum, lodOrigin, true);
+        if (selection.empty()) continue;
+        lastNodeCount += (int)selection.size();
+
+        // Sample 0 of the heightmap is the border sample one unit before the tile's corner
+        glBindTexture(GL_TEXTURE_2D, tile.heightmap);
+        activeShader.SetVec3("uTerrainExtent", glm::vec3(tile.origin.x, tile.origin.y, (float)tile.size));
+        activeShader.SetVec4("uHeightmapRect", glm::vec4(tile.origin.x - 1.0f, tile.origin.y - 1.0f, 1.0f, (float)tile.samples));
+
+        for (const Node& node : selection) {
+            float size = (float)(TERRAIN_PATCH_RES << node.level);
+            float morphEnd = LodRange(node.level);
+            float previous = node.level > 0 ? LodRange(node.level - 1) : 0.0f;
+            activeShader.SetVec3("uTerrainNode", glm::vec3(tile.origin.x + node.x * size, tile.origin.y + node.z * size, size));
+            activeShader.SetVec2("uTerrainMorph", glm::vec2(previous + (morphEnd - previous) * TERRAIN_MORPH_START, morphEnd));
+
+            if (node.quadrants == 0xF) {
+                glDrawElements(GL_TRIANGLES, patchIndexCount, GL_UNSIGNED_INT, 0);
+                continue;
+            }
+            for (int q = 0; q < 4; q++) {
+                if (node.quadrants & (1 << q))
+                    glDrawElements(GL_TRIANGLES, quarter, GL_UNSIGNED_INT, (void*)(q * quarter * sizeof(unsigned int)));
+            }
+        }
+    }
+    glActiveTexture(GL_TEXTURE0);
     glBindVertexArray(0);
-}
 
-void Terrain::Unload() {
-    glDeleteVertexArrays(1, &VAO);
-    glDeleteBuffers(1, &VBO);
-    glDeleteBuffers(1, &EBO);
-    glDeleteTextures(1, &texture);
-    shader.Unload();
-    VAO = VBO = EBO = texture = 0;
-    indexCount = 0;
+    activeShader.SetInt("uTerrain", 0);
 }
 
-unsigned int Terrain::LoadTexture(const std::string& path) {
-    unsigned int textureID;
-    glGenTextures(1, &textureID);
-    glBindTexture(GL_TEXTURE_2D, textureID);
+void Terrain::Render(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& cameraPos) {
+    glUseProgram(shader.programID);
 
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glm::mat4 viewProjection = projection * view;
+    shader.SetMat4("uMVP", viewProjection);
 
-    int width, height, nrChannels;
-    unsigned char* data = stbi_load(path.c_str(), &width, &height, &nrChannels, 0);
-    if (data) {
-        GLenum format = (nrChannels == 4) ? GL_RGBA : GL_RGB;
-        glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-        glGenerateMipmap(GL_TEXTURE_2D);
-    } else {
-        std::cout << "ERROR::TERRAIN::FAILED_TO_LOAD_TEXTURE: " << path << std::endl;
-    }
-    stbi_image_free(data);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, texture);
 
-    return textureID;
+    DrawGeometry(shader, viewProjection, cameraPos);
+}
+
+void Terrain::Unload() {
+    // Jobs write into staging and post back to this terrain; let them finish first
+    if (streamJobs > 0) StreamPool().Wait();
+    streamJobs = 0;
+    streamFinished.clear();
+
+    glDeleteVertexArrays(1, &patchVAO);
+    glDeleteBuffers(1, &patchVBO);
+    glDeleteBuffers(1, &patchEBO);
+    for (Tile& tile : tiles)
+        glDeleteTextures(1, &tile.heightmap);
+    TextureManager::Release(texture);
+    shader.Unload();
+    patchVAO = patchVBO = patchEBO = texture = 0;
+    patchIndexCount = 0;
+    tiles.clear();
+    staging.clear();
+    ringOffsets.clear();
+    streamGenerator = nullptr;
+    selection.clear();
+    lastNodeCount = 0;
 }
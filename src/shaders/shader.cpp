@@ -1,5 +1,6 @@
 #include "shaders/shader.hpp"
 #include "utils/utility.hpp"
+#include <glm/gtc/type_ptr.hpp>
 
 Shader::Shader() {
 
@@ -23,8 +24,11 @@ void Shader::ReloadFromFile() {
         // will contain new code this time
         Shader s = Shader::LoadShader(this->vertexFile, this->fragmentFile);
 
-        // Discard newly loaded shader, but persist the shader program id it created during loading
+        // Discard newly loaded shader, but persist the shader program id and uniform table it created
         this->programID = s.programID;
+        this->linkId = s.linkId;
+        this->uniformLocations = std::move(s.uniformLocations);
+        this->uniformArrays = std::move(s.uniformArrays);
         // Set the latest fragment file modified time to the current time
         this->fragmentModTimeOnLoad = currentModTime;
     }
@@ -84,6 +88,10 @@ Shader Shader::LoadShader(std::string fileVertexShader, std::string fileFragment
         return Shader{};
     }
 
+    // Expand #include "file" directives (paths are relative to the including shader)
+    ResolveIncludes(vertexCode, fileVertexShader);
+    ResolveIncludes(fragmentCode, fileFragmentShader);
+
     // Turns them into c-strings
     const char* vertexCodeCstr = vertexCode.c_str();
     const char* fragmentCodeCstr = fragmentCode.c_str();
@@ -131,6 +139,11 @@ Shader Shader::LoadShader(std::string fileVertexShader, std::string fileFragment
     s.programID = programID;
     s.vertexFile = fileVertexShader;
     s.fragmentFile = fileFragmentShader;
+    if (!anyError) {
+        static unsigned int nextLinkId = 1;
+        s.linkId = nextLinkId++;
+        s.ReflectUniforms();
+    }
 
     // If we at any point did NOT get an error, then we say that it loaded successfully
     if (!anyError) {
@@ -138,4 +151,122 @@ Shader Shader::LoadShader(std::string fileVertexShader, std::string fileFragment
     }
 
     return s;
-}
\ No newline at end of file
+}
+
+void Shader::ResolveIncludes(std::string& code, const std::string& file, int depth) {
+    if (depth > 8) {
+        std::cout << "ERROR::SHADER::INCLUDE(" << file << ")::TOO_DEEP" << std::endl;
+        return;
+    }
+
+    std::string directory = file.substr(0, file.find_last_of("/\\") + 1);
+    const std::string directive = "#include \"";
+
+    size_t pos = 0;
+    while ((pos = code.find(directive, pos)) != std::string::npos) {
+        size_t nameStart = pos + directive.size();
+        size_t nameEnd = code.find('"', nameStart);
+        size_t lineEnd = code.find('\n', pos);
+        if (nameEnd == std::string::npos || nameEnd > lineEnd) {
+            pos = nameStart;
+            continue;
+        }
+
+        std::string includeFile = directory + code.substr(nameStart, nameEnd - nameStart);
+        std::string includeCode;
+        if (!ReadFile(includeFile, includeCode, true)) {
+            std::cout << "ERROR::SHADER::INCLUDE(" << includeFile << ")::FILE_NOT_FOUND" << std::endl;
+            includeCode = "";
+        }
+        ResolveIncludes(includeCode, includeFile, depth + 1);
+
+        size_t replaceEnd = (lineEnd == std::string::npos) ? code.size() : lineEnd + 1;
+        code.replace(pos, replaceEnd - pos, includeCode);
+        pos += includeCode.size();
+    }
+}
+
+void Shader::ReflectUniforms() {
+    uniformLocations.clear();
+    uniformArrays.clear();
+
+    int count = 0, maxLength = 0;
+    glGetProgramiv(programID, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(programID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+    std::vector<char> nameBuffer(maxLength > 0 ? maxLength : 1);
+
+    for (int i = 0; i < count; i++) {
+        int size = 0, length = 0;
+        GLenum type;
+        glGetActiveUniform(programID, i, (int)nameBuffer.size(), &length, &size, &type, nameBuffer.data());
+        std::string name(nameBuffer.data(), length);
+
+        // Arrays are reported once as "name[0]" with their active size
+        bool isArray = name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0;
+        if (!isArray) {
+            uniformLocations[name] = glGetUniformLocation(programID, name.c_str());
+            continue;
+        }
+
+        std::string base = name.substr(0, name.size() - 3);
+        std::vector<int> elements(size);
+        for (int e = 0; e < size; e++) {
+            std::string element = base + "[" + std::to_string(e) + "]";
+            elements[e] = glGetUniformLocation(programID, element.c_str());
+            uniformLocations[element] = elements[e];
+        }
+        uniformLocations[base] = elements[0];
+        uniformArrays[base] = std::move(elements);
+    }
+}
+
+int Shader::GetUniformLocation(std::string_view name) const {
+    auto it = uniformLocations.find(name);
+    return (it != uniformLocations.end()) ? it->second : -1;
+}
+
+int Shader::GetUniformLocation(std::string_view arrayName, int index) const {
+    auto it = uniformArrays.find(arrayName);
+    if (it == uniformArrays.end() || index < 0 || index >= (int)it->second.size()) return -1;
+    return it->second[index];
+}
+
+void Shader::SetInt(std::string_view name, int value) const {
+    glUniform1i(GetUniformLocation(name), value);
+}
+
+void Shader::SetFloat(std::string_view name, float value) const {
+    glUniform1f(GetUniformLocation(name), value);
+}
+
+void Shader::SetVec2(std::string_view name, const glm::vec2& value) const {
+    glUniform2fv(GetUniformLocation(name), 1, glm::value_ptr(value));
+}
+
+void Shader::SetVec3(std::string_view name, const glm::vec3& value) const {
+    glUniform3fv(GetUniformLocation(name), 1, glm::value_ptr(value));
+}
+
+void Shader::SetVec4(std::string_view name, const glm::vec4& value) const {
+    glUniform4fv(GetUniformLocation(name), 1, glm::value_ptr(value));
+}
+
+void Shader::SetMat4(std::string_view name, const glm::mat4& value) const {
+    glUniformMatrix4fv(GetUniformLocation(name), 1, GL_FALSE, glm::value_ptr(value));
+}
+
+void Shader::SetInt(std::string_view arrayName, int index, int value) const {
+    glUniform1i(GetUniformLocation(arrayName, index), value);
+}
+
+void Shader::SetFloat(std::string_view arrayName, int index, float value) const {
+    glUniform1f(GetUniformLocation(arrayName, index), value);
+}
+
+void Shader::SetVec3(std::string_view arrayName, int index, const glm::vec3& value) const {
+    glUniform3fv(GetUniformLocation(arrayName, index), 1, glm::value_ptr(value));
+}
+
+void Shader::SetMat4(std::string_view arrayName, int index, const glm::mat4& value) const {
+    glUniformMatrix4fv(GetUniformLocation(arrayName, index), 1, GL_FALSE, glm::value_ptr(value));
+}
@@ -0,0 +1,390 @@
+#include "textures/texture_manager.hpp"
+#include "utils/thread_pool.hpp"
+#include "glad.h"
+#include "stb_image.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+
+bool TextureManager::cpuMipmaps = true;
+
+std::unordered_map<unsigned int, TextureManager::Entry> TextureManager::entries;
+std::unordered_map<std::string, unsigned int> TextureManager::byPath;
+std::unordered_map<uint64_t, unsigned int> TextureManager::byContent;
+std::atomic<int> TextureManager::decodeCount = 0;
+uint64_t TextureManager::nextJob = 0;
+
+std::unique_ptr<ThreadPool> TextureManager::pool;
+std::mutex TextureManager::completedMutex;
+std::deque<std::unique_ptr<TextureManager::DecodedTexture>> TextureManager::completed;
+std::deque<std::unique_ptr<TextureManager::DecodedTexture>> TextureManager::uploads;
+unsigned int TextureManager::uploadPBO = 0;
+
+static double NowMs() {
+    using namespace std::chrono;
+    return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+}
+
+static bool ReadBytes(const std::string& path, std::vector<unsigned char>& bytes) {
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file) return false;
+    std::streamsize size = file.tellg();
+    if (size <= 0) return false;
+    bytes.resize((size_t)size);
+    file.seekg(0);
+    return (bool)file.read((char*)bytes.data(), size);
+}
+
+// FNV-1a over 8-byte words; only used to spot identical files under different paths
+static uint64_t HashBytes(const std::vector<unsigned char>& bytes, uint64_t hash = 14695981039346656037ull) {
+    size_t i = 0;
+    for (; i + 8 <= bytes.size(); i += 8) {
+        uint64_t word;
+        std::memcpy(&word, bytes.data() + i, 8);
+        hash = (hash ^ word) * 1099511628211ull;
+    }
+    for (; i < bytes.size(); i++)
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    return hash;
+}
+
+// Grey checker shown until the decoded image has been uploaded
+static void UploadPlaceholder(GLenum target) {
+    const unsigned char checker[16] = {
+        128, 128, 128, 255,  200, 200, 200, 255,
+        200, 200, 200, 255,  128, 128, 128, 255,
+    };
+    glTexImage2D(target, 0, GL_RGBA, 2, 2, 0, GL_RGBA, GL_UNSIGNED_BYTE, checker);
+}
+
+ThreadPool& TextureManager::Pool() {
+    if (!pool) pool = std::make_unique<ThreadPool>(std::min(ThreadPool::DefaultThreadCount(), 4));
+    return *pool;
+}
+
+unsigned int TextureManager::Find(const std::string& key, uint64_t contentHash) {
+    auto it = byContent.find(contentHash);
+    if (it == byContent.end()) return 0;
+
+    // Same bytes under a new path: remember the alias so the next lookup skips the read
+    Entry& entry = entries[it->second];
+    entry.refCount++;
+    entry.keys.push_back(key);
+    byPath[key] = it->second;
+    return it->second;
+}
+
+unsigned int TextureManager::Insert(unsigned int textureID, unsigned int target,
+                                    const std::string& key, uint64_t contentHash) {
+    entries[textureID] = { target, 1, contentHash, { key }, ++nextJob, false };
+    byPath[key] = textureID;
+    byContent[contentHash] = textureID;
+    return textureID;
+}
+
+// Runs on a worker: decode every face and optionally build its mip chain
+void TextureManager::Decode(DecodedTexture& out, const std::vector<std::vector<unsigned char>>& files, bool mipmaps) {
+    out.faces.resize(files.size());
+    for (int f = 0; f < (int)files.size(); f++) {
+        if (files[f].empty()) continue;
+
+        // Grey(+alpha) images are expanded so everything uploads as RGB or RGBA
+        int width, height, channels;
+        if (!stbi_info_from_memory(files[f].data(), (int)files[f].size(), &width, &height, &channels)) continue;
+        int wanted = (channels == 2 || channels == 4) ? 4 : 3;
+        unsigned char* data = stbi_load_from_memory(files[f].data(), (int)files[f].size(),
+                                                    &width, &height, &channels, wanted);
+        if (!data) continue;
+        decodeCount++;
+
+        ImageLevel base;
+        base.width = width;
+        base.height = height;
+        base.channels = wanted;
+        base.pixels.assign(data, data + (size_t)width * height * wanted);
+        stbi_image_free(data);
+        out.faces[f].push_back(std::move(base));
+
+        // 2x2 box filter down to 1x1, clamping at odd edges
+        while (mipmaps && (out.faces[f].back().width > 1 || out.faces[f].back().height > 1)) {
+            const ImageLevel& src = out.faces[f].back();
+            ImageLevel dst;
+            dst.width = std::max(src.width / 2, 1);
+            dst.height = std::max(src.height / 2, 1);
+            dst.channels = wanted;
+            dst.pixels.resize((size_t)dst.width * dst.height * wanted);
+            for (int y = 0; y < dst.height; y++) {
+                int y0 = std::min(y * 2, src.height - 1), y1 = std::min(y * 2 + 1, src.height - 1);
+                for (int x = 0; x < dst.width; x++) {
+                    int x0 = std::min(x * 2, src.width - 1), x1 = std::min(x * 2 + 1, src.width - 1);
+                    for (int c = 0; c < wanted; c++) {
+                        int sum = src.pixels[((size_t)y0 * src.width + x0) * wanted + c]
+                                + src.pixels[((size_t)y0 * src.width + x1) * wanted + c]
+                                + src.pixels[((size_t)y1 * src.width + x0) * wanted + c]
+                                + src.pixels[((size_t)y1 * src.width + x1) * wanted + c];
+                        dst.pixels[((size_t)y * dst.width + x) * wanted + c] = (unsigned char)((sum + 2) / 4);
+                    }
+                }
+            }
+            out.faces[f].push_back(std::move(dst));
+        }
+    }
+}
+
+unsigned int TextureManager::Load2D(const std::string& path) {
+    auto it = byPath.find(path);
+    if (it != byPath.end()) {
+        entries[it->second].refCount++;
+        return it->second;
+    }
+
+    // Reading and hashing stay on this thread so duplicates resolve to one ID immediately
+    std::vector<std::vector<unsigned char>> files(1);
+    if (!ReadBytes(path, files[0])) {
+        std::cout << "ERROR::TEXTURE::FAILED_TO_READ: " << path << std::endl;
+        return 0;
+    }
+    uint64_t hash = HashBytes(files[0]) ^ GL_TEXTURE_2D;
+    if (unsigned int shared = Find(path, hash)) return shared;
+
+    unsigned int textureID;
+    glGenTextures(1, &textureID);
+    glBindTexture(GL_TEXTURE_2D, textureID);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    UploadPlaceholder(GL_TEXTURE_2D);
+
+    Insert(textureID, GL_TEXTURE_2D, path, hash);
+    uint64_t job = entries[textureID].job;
+    bool mipmaps = cpuMipmaps;
+    Pool().Submit([textureID, job, mipmaps, path, files = std::move(files)]() {
+        auto decoded = std::make_unique<DecodedTexture>();
+        decoded->textureID = textureID;
+        decoded->job = job;
+        Decode(*decoded, files, mipmaps);
+        if (decoded->faces[0].empty())
+            std::cout << "ERROR::TEXTURE::FAILED_TO_DECODE: " << path << std::endl;
+
+        std::lock_guard<std::mutex> lock(completedMutex);
+        completed.push_back(std::move(decoded));
+    });
+    return textureID;
+}
+
+unsigned int TextureManager::LoadCubemap(const std::vector<std::string>& faces) {
+    std::string key = "cubemap:";
+    for (const auto& face : faces) key += face + "|";
+
+    auto it = byPath.find(key);
+    if (it != byPath.end()) {
+        entries[it->second].refCount++;
+        return it->second;
+    }
+
+    std::vector<std::vector<unsigned char>> files(faces.size());
+    uint64_t hash = 14695981039346656037ull;
+    for (int i = 0; i < (int)faces.size(); i++) {
+        if (!ReadBytes(faces[i], files[i]))
+            std::cout << "ERROR::TEXTURE::FAILED_TO_READ: " << faces[i] << std::endl;
+        hash = HashBytes(files[i], hash);
+    }
+    hash ^= GL_TEXTURE_CUBE_MAP;
+    if (unsigned int shared = Find(key, hash)) return shared;
+
+    unsigned int textureID;
+    glGenTextures(1, &textureID);
+    glBindTexture(GL_TEXTURE_CUBE_MAP, textureID);
+
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+    for (int i = 0; i < (int)faces.size(); i++)
+        UploadPlaceholder(GL_TEXTURE_CUBE_MAP_POSITIVE_X + i);
+
+    Insert(textureID, GL_TEXTURE_CUBE_MAP, key, hash);
+    uint64_t job = entries[textureID].job;
+    Pool().Submit([textureID, job, faces, files = std::move(files)]() {
+        auto decoded = std::make_unique<DecodedTexture>();
+        decoded->textureID = textureID;
+        decoded->job = job;
+        Decode(*decoded, files, false);
+        // A cubemap with only some faces replaced is incomplete and samples black, so any
+        // failure keeps the whole placeholder
+        bool complete = true;
+        for (int i = 0; i < (int)faces.size(); i++) {
+            const std::vector<ImageLevel>& face = decoded->faces[i];
+            if (face.empty()) {
+                std::cout << "ERROR::TEXTURE::FAILED_TO_DECODE: " << faces[i] << std::endl;
+                complete = false;
+            } else if (!decoded->faces[0].empty() && (face[0].width != decoded->faces[0][0].width ||
+                                                      face[0].height != decoded->faces[0][0].height)) {
+                std::cout << "ERROR::TEXTURE::CUBEMAP_FACE_SIZE_MISMATCH: " << faces[i] << std::endl;
+                complete = false;
+            }
+        }
+        if (!complete)
+            for (auto& face : decoded->faces) face.clear();
+
+        std::lock_guard<std::mutex> lock(completedMutex);
+        completed.push_back(std::move(decoded));
+    });
+    return textureID;
+}
+
+// Copy the next band of rows of the current face/level through the staging PBO
+void TextureManager::UploadBand(DecodedTexture& texture, unsigned int target) {
+    const ImageLevel& level = texture.faces[texture.nextFace][texture.nextLevel];
+    GLenum imageTarget = (target == GL_TEXTURE_CUBE_MAP) ? GL_TEXTURE_CUBE_MAP_POSITIVE_X + texture.nextFace : target;
+    GLenum format = (level.channels == 4) ? GL_RGBA : GL_RGB;
+    size_t rowBytes = (size_t)level.width * level.channels;
+    int rows = std::min(std::max((int)(TEXTURE_UPLOAD_CHUNK_BYTES / rowBytes), 1), level.height - texture.nextRow);
+    size_t size = rowBytes * rows;
+
+    glBindTexture(target, texture.textureID);
+    // RGB rows may not be 4-byte aligned — tell OpenGL to expect tight packing
+    if (level.channels == 3) glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    // First band replaces the placeholder storage with the real size. Cubemap faces all get
+    // theirs before the first band of face 0, so the texture stays complete while streaming
+    if (texture.nextRow == 0 && target != GL_TEXTURE_CUBE_MAP) {
+        glTexImage2D(imageTarget, texture.nextLevel, format, level.width, level.height, 0,
+                     format, GL_UNSIGNED_BYTE, nullptr);
+    } else if (texture.nextRow == 0 && texture.nextFace == 0) {
+        GLenum internalFormat = GL_RGB;
+        for (const auto& face : texture.faces)
+            if (face[0].channels == 4) internalFormat = GL_RGBA;
+        for (int f = 0; f < (int)texture.faces.size(); f++)
+            glTexImage2D(GL_TEXTURE_CUBE_MAP_POSITIVE_X + f, 0, internalFormat, level.width, level.height, 0,
+                         format, GL_UNSIGNED_BYTE, nullptr);
+    }
+
+    if (uploadPBO == 0) glGenBuffers(1, &uploadPBO);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, uploadPBO);
+    // Orphan so the copy never waits on a transfer the driver still has in flight
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+    void* dst = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    if (dst) {
+        std::memcpy(dst, level.pixels.data() + rowBytes * texture.nextRow, size);
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        glTexSubImage2D(imageTarget, texture.nextLevel, 0, texture.nextRow, level.width, rows,
+                        format, GL_UNSIGNED_BYTE, (void*)0);
+    } else {
+        std::cout << "ERROR::TEXTURE::PBO_MAP_FAILED" << std::endl;
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    if (level.channels == 3) glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    texture.nextRow += rows;
+}
+
+void TextureManager::ProcessUploads(double budgetMs) {
+    {
+        std::lock_guard<std::mutex> lock(completedMutex);
+        while (!completed.empty()) {
+            uploads.push_back(std::move(completed.front()));
+            completed.pop_front();
+        }
+    }
+
+    double start = NowMs();
+    while (!uploads.empty() && NowMs() - start < budgetMs) {
+        DecodedTexture& texture = *uploads.front();
+
+        // Released and collected (or the ID reused) while the decode was running
+        auto it = entries.find(texture.textureID);
+        if (it == entries.end() || it->second.job != texture.job) {
+            uploads.pop_front();
+            continue;
+        }
+        Entry& entry = it->second;
+
+        // Skip faces that failed to decode; they keep the placeholder
+        while (texture.nextFace < (int)texture.faces.size() &&
+               texture.nextLevel >= (int)texture.faces[texture.nextFace].size()) {
+            texture.nextFace++;
+            texture.nextLevel = 0;
+        }
+
+        if (texture.nextFace < (int)texture.faces.size()) {
+            UploadBand(texture, entry.target);
+            ImageLevel& level = texture.faces[texture.nextFace][texture.nextLevel];
+            if (texture.nextRow >= level.height) {
+                // Drop the CPU copy as soon as it's on the GPU
+                std::vector<unsigned char>().swap(level.pixels);
+                texture.nextLevel++;
+                texture.nextRow = 0;
+            }
+            continue;
+        }
+
+        // Every level is in; finish the mip chain and hand the texture over
+        if (entry.target == GL_TEXTURE_2D && !texture.faces[0].empty()) {
+            glBindTexture(GL_TEXTURE_2D, texture.textureID);
+            int levels = (int)texture.faces[0].size();
+            if (levels > 1)
+                glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1);
+            else
+                glGenerateMipmap(GL_TEXTURE_2D);
+        }
+        entry.ready = true;
+        uploads.pop_front();
+    }
+}
+
+void TextureManager::FinishPending() {
+    if (pool) pool->Wait();
+    ProcessUploads(std::numeric_limits<double>::infinity());
+}
+
+int TextureManager::PendingCount() {
+    int pending = 0;
+    for (const auto& [id, entry] : entries)
+        if (!entry.ready) pending++;
+    return pending;
+}
+
+void TextureManager::Release(unsigned int textureID) {
+    auto it = entries.find(textureID);
+    if (it == entries.end()) return;
+    if (it->second.refCount > 0) it->second.refCount--;
+}
+
+void TextureManager::Destroy(unsigned int textureID) {
+    const Entry& entry = entries[textureID];
+    for (const auto& key : entry.keys) byPath.erase(key);
+    byContent.erase(entry.contentHash);
+    glDeleteTextures(1, &textureID);
+    entries.erase(textureID);
+}
+
+void TextureManager::CollectUnused() {
+    std::vector<unsigned int> unused;
+    for (const auto& [id, entry] : entries)
+        if (entry.refCount == 0) unused.push_back(id);
+    for (unsigned int id : unused)
+        Destroy(id);
+}
+
+void TextureManager::Shutdown() {
+    // Joins the workers; anything they finish is discarded with the queues below
+    pool.reset();
+    completed.clear();
+    uploads.clear();
+
+    for (const auto& [id, entry] : entries)
+        glDeleteTextures(1, &id);
+    entries.clear();
+    byPath.clear();
+    byContent.clear();
+
+    if (uploadPBO) glDeleteBuffers(1, &uploadPBO);
+    uploadPBO = 0;
+}
@@ -0,0 +1,239 @@
+#include "utils/profiler.hpp"
+#include "glad.h"
+#include "imgui.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+bool Profiler::enabled = true;
+bool Profiler::gpuTiming = true;
+
+std::vector<ProfilerSection> Profiler::sections;
+std::vector<Profiler::OpenSection> Profiler::stack;
+Profiler::FrameQueries Profiler::frames[PROFILER_FRAME_LATENCY];
+float Profiler::frameMs[PROFILER_HISTORY] = {};
+uint64_t Profiler::frameIndex = 0;
+double Profiler::frameStart = 0.0;
+
+static double NowMs() {
+    using namespace std::chrono;
+    return duration<double, std::milli>(steady_clock::now().time_since_epoch()).count();
+}
+
+void Profiler::BeginFrame() {
+    double now = NowMs();
+    if (frameIndex > 0)
+        frameMs[frameIndex % PROFILER_HISTORY] = (float)(now - frameStart);
+    frameStart = now;
+    frameIndex++;
+
+    // Clear this frame's slot so sections that don't run this frame read as zero
+    int slot = (int)(frameIndex % PROFILER_HISTORY);
+    for (auto& s : sections) {
+        s.cpuMs[slot] = 0.0f;
+        s.gpuMs[slot] = 0.0f;
+    }
+    stack.clear();
+
+    // Reuse the query set from PROFILER_FRAME_LATENCY frames ago, harvesting it first if ready
+    FrameQueries& fq = frames[frameIndex % PROFILER_FRAME_LATENCY];
+    CollectGpuResults(fq);
+    fq.frame = frameIndex;
+    fq.used = 0;
+    fq.records.clear();
+}
+
+void Profiler::EndFrame() {
+    // Close anything left open so a missing EndSection can't poison the next frame
+    while (!stack.empty())
+        EndSection();
+}
+
+int Profiler::FindOrAddSection(const char* name, int depth) {
+    for (int i = 0; i < (int)sections.size(); i++) {
+        if (std::strcmp(sections[i].name.c_str(), name) == 0) {
+            sections[i].depth = depth;
+            return i;
+        }
+    }
+    ProfilerSection s;
+    s.name = name;
+    s.depth = depth;
+    sections.push_back(s);
+    return (int)sections.size() - 1;
+}
+
+unsigned int Profiler::AcquireQuery(FrameQueries& fq) {
+    if (fq.used == (int)fq.pool.size()) {
+        unsigned int query;
+        glGenQueries(1, &query);
+        fq.pool.push_back(query);
+    }
+    return fq.pool[fq.used++];
+}
+
+void Profiler::BeginSection(const char* name) {
+    if (!enabled || frameIndex == 0) return;
+
+    OpenSection open;
+    open.section = FindOrAddSection(name, (int)stack.size());
+    open.cpuStart = NowMs();
+    open.record = -1;
+
+    // Timestamps (not GL_TIME_ELAPSED) so sections can nest
+    if (gpuTiming) {
+        FrameQueries& fq = frames[frameIndex % PROFILER_FRAME_LATENCY];
+        GpuRecord rec;
+        rec.section = open.section;
+        rec.queryBegin = AcquireQuery(fq);
+        rec.queryEnd = AcquireQuery(fq);
+        glQueryCounter(rec.queryBegin, GL_TIMESTAMP);
+        open.record = (int)fq.records.size();
+        fq.records.push_back(rec);
+    }
+
+    stack.push_back(open);
+}
+
+void Profiler::EndSection() {
+    if (stack.empty()) return;
+
+    OpenSection open = stack.back();
+    stack.pop_back();
+
+    if (open.record >= 0) {
+        FrameQueries& fq = frames[frameIndex % PROFILER_FRAME_LATENCY];
+        glQueryCounter(fq.records[open.record].queryEnd, GL_TIMESTAMP);
+    }
+
+    ProfilerSection& s = sections[open.section];
+    s.cpuMs[frameIndex % PROFILER_HISTORY] += (float)(NowMs() - open.cpuStart);
+    s.lastFrame = frameIndex;
+}
+
+void Profiler::CollectGpuResults(FrameQueries& fq) {
+    if (fq.records.empty()) return;
+
+    // Queries complete in order, so the last end stamp tells us whether the whole set is ready.
+    // If it isn't, drop the frame rather than wait.
+    int available = 0;
+    glGetQueryObjectiv(fq.records.back().queryEnd, GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available) return;
+
+    int slot = (int)(fq.frame % PROFILER_HISTORY);
+    for (const auto& rec : fq.records) {
+        GLuint64 begin = 0, end = 0;
+        glGetQueryObjectui64v(rec.queryBegin, GL_QUERY_RESULT, &begin);
+        glGetQueryObjectui64v(rec.queryEnd, GL_QUERY_RESULT, &end);
+        sections[rec.section].gpuMs[slot] += (float)((end - begin) / 1.0e6);
+    }
+}
+
+int Profiler::FrameCount() {
+    return (int)std::min<uint64_t>(frameIndex > 0 ? frameIndex - 1 : 0, PROFILER_HISTORY);
+}
+
+float Profiler::FrameTimePercentile(float p, int count) {
+    count = std::min(count, FrameCount());
+    if (count <= 0) return 0.0f;
+
+    std::vector<float> samples(count);
+    for (int i = 0; i < count; i++)
+        samples[i] = frameMs[(frameIndex - 1 - i) % PROFILER_HISTORY];
+
+    int k = std::clamp((int)(p * (count - 1) + 0.5f), 0, count - 1);
+    std::nth_element(samples.begin(), samples.begin() + k, samples.end());
+    return samples[k];
+}
+
+void Profiler::Reset() {
+    stack.clear();
+    for (auto& s : sections) {
+        std::fill(std::begin(s.cpuMs), std::end(s.cpuMs), 0.0f);
+        std::fill(std::begin(s.gpuMs), std::end(s.gpuMs), 0.0f);
+    }
+    std::fill(std::begin(frameMs), std::end(frameMs), 0.0f);
+    for (auto& fq : frames)
+        fq.records.clear();
+    frameIndex = 0;
+}
+
+void Profiler::Shutdown() {
+    for (auto& fq : frames) {
+        if (!fq.pool.empty())
+            glDeleteQueries((int)fq.pool.size(), fq.pool.data());
+        fq.pool.clear();
+        fq.records.clear();
+        fq.used = 0;
+    }
+    sections.clear();
+    stack.clear();
+    frameIndex = 0;
+}
+
+static float AverageOver(const float* history, uint64_t lastFrame, int count) {
+    float sum = 0.0f;
+    for (int i = 0; i < count; i++)
+        sum += history[(lastFrame - i) % PROFILER_HISTORY];
+    return sum / count;
+}
+
+void Profiler::RenderUI() {
+    ImGuiViewport* viewport = ImGui::GetMainViewport();
+    ImGui::SetNextWindowPos(ImVec2(viewport->WorkPos.x + viewport->WorkSize.x - 370.0f,
+                                   viewport->WorkPos.y + 40.0f), ImGuiCond_FirstUseEver);
+    ImGui::SetNextWindowSize(ImVec2(360.0f, 420.0f), ImGuiCond_FirstUseEver);
+    ImGui::Begin("Profiler");
+
+    ImGui::Checkbox("Enabled", &enabled);
+    ImGui::SameLine();
+    ImGui::Checkbox("GPU timers", &gpuTiming);
+
+    int count = FrameCount();
+    if (count > 0) {
+        ImGui::Text("Frame  p50 %.2f  p95 %.2f  p99 %.2f ms",
+                    FrameTimePercentile(0.50f), FrameTimePercentile(0.95f), FrameTimePercentile(0.99f));
+        char overlay[32];
+        snprintf(overlay, sizeof(overlay), "%.2f ms", frameMs[(frameIndex - 1) % PROFILER_HISTORY]);
+        ImGui::PlotHistogram("##frame", frameMs, PROFILER_HISTORY, (int)(frameIndex % PROFILER_HISTORY),
+                             overlay, 0.0f, FrameTimePercentile(0.99f) * 1.5f, ImVec2(-1.0f, 60.0f));
+    }
+
+    // CPU values are from the last finished frame, GPU values lag by the query latency
+    const int avgFrames = 60;
+    if (count > avgFrames + PROFILER_FRAME_LATENCY &&
+        ImGui::BeginTable("##sections", 4, ImGuiTableFlags_RowBg | ImGuiTableFlags_SizingFixedFit)) {
+        ImGui::TableSetupColumn("Section", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableSetupColumn("CPU ms");
+        ImGui::TableSetupColumn("GPU ms");
+        ImGui::TableSetupColumn("GPU history");
+        ImGui::TableHeadersRow();
+
+        uint64_t cpuFrame = frameIndex - 1;
+        uint64_t gpuFrame = frameIndex - PROFILER_FRAME_LATENCY;
+        for (int i = 0; i < (int)sections.size(); i++) {
+            const ProfilerSection& s = sections[i];
+            if (s.lastFrame + 2 < frameIndex) continue;
+
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            ImGui::Indent(s.depth * 8.0f + 1.0f);
+            ImGui::TextUnformatted(s.name.c_str());
+            ImGui::Unindent(s.depth * 8.0f + 1.0f);
+            ImGui::TableNextColumn();
+            ImGui::Text("%6.3f", AverageOver(s.cpuMs, cpuFrame, avgFrames));
+            ImGui::TableNextColumn();
+            if (gpuTiming) ImGui::Text("%6.3f", AverageOver(s.gpuMs, gpuFrame, avgFrames));
+            else ImGui::TextDisabled("-");
+            ImGui::TableNextColumn();
+            ImGui::PushID(i);
+            ImGui::PlotHistogram("##gpu", s.gpuMs, PROFILER_HISTORY,
+                                 (int)((gpuFrame + 1) % PROFILER_HISTORY), nullptr,
+                                 0.0f, FLT_MAX, ImVec2(100.0f, 16.0f));
+            ImGui::PopID();
+        }
+        ImGui::EndTable();
+    }
+
+    ImGui::End();
+}
@@ -0,0 +1,43 @@
+#include "utils/render_stats.hpp"
+#include "glad.h"
+
+unsigned long long RenderStats::drawCalls = 0;
+unsigned long long RenderStats::triangles = 0;
+
+static PFNGLDRAWARRAYSPROC realDrawArrays = nullptr;
+static PFNGLDRAWELEMENTSPROC realDrawElements = nullptr;
+static PFNGLDRAWELEMENTSINSTANCEDPROC realDrawElementsInstanced = nullptr;
+
+static void CountDraw(GLenum mode, GLsizei count, GLsizei instances) {
+    RenderStats::drawCalls++;
+    if (mode == GL_TRIANGLES)
+        RenderStats::triangles += (unsigned long long)(count / 3) * instances;
+}
+
+static void APIENTRY CountingDrawArrays(GLenum mode, GLint first, GLsizei count) {
+    CountDraw(mode, count, 1);
+    realDrawArrays(mode, first, count);
+}
+
+static void APIENTRY CountingDrawElements(GLenum mode, GLsizei count, GLenum type, const void* indices) {
+    CountDraw(mode, count, 1);
+    realDrawElements(mode, count, type, indices);
+}
+
+static void APIENTRY CountingDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type,
+                                                   const void* indices, GLsizei instances) {
+    CountDraw(mode, count, instances);
+    realDrawElementsInstanced(mode, count, type, indices, instances);
+}
+
+void RenderStats::Install() {
+    if (realDrawElements) return;
+
+    realDrawArrays = glad_glDrawArrays;
+    realDrawElements = glad_glDrawElements;
+    realDrawElementsInstanced = glad_glDrawElementsInstanced;
+
+    glad_glDrawArrays = CountingDrawArrays;
+    glad_glDrawElements = CountingDrawElements;
+    glad_glDrawElementsInstanced = CountingDrawElementsInstanced;
+}
@@ -0,0 +1,142 @@
+#include "utils/replay.hpp"
+#include "utils/time.hpp"
+#include <fstream>
+#include <iterator>
+#include <iostream>
+
+// Keys read by the player cars and the free camera
+static const int trackedKeys[] = {
+    GLFW_KEY_W, GLFW_KEY_A, GLFW_KEY_S, GLFW_KEY_D, GLFW_KEY_Q, GLFW_KEY_E,
+    GLFW_KEY_SPACE, GLFW_KEY_LEFT_SHIFT, GLFW_KEY_LEFT_CONTROL
+};
+
+static int TrackedKeyBit(int key) {
+    for (int i = 0; i < (int)std::size(trackedKeys); i++)
+        if (trackedKeys[i] == key) return i;
+    return -1;
+}
+
+Replay::Mode Replay::mode = Replay::Mode::Off;
+Recording Replay::recording;
+ReplayFrame Replay::current = {};
+int Replay::frameIndex = 0;
+int Replay::stepIndex = 0;
+int Replay::mismatches = 0;
+int Replay::firstMismatch = -1;
+
+bool Recording::Save(const std::string& path) const {
+    std::ofstream f(path, std::ios::binary);
+    if (!f.is_open()) {
+        std::cout << "ERROR::REPLAY::CANNOT_WRITE: " << path << std::endl;
+        return false;
+    }
+    uint32_t header[] = { REPLAY_MAGIC, REPLAY_VERSION, (uint32_t)scene, seed,
+                          (uint32_t)frames.size(), (uint32_t)stepHashes.size() };
+    f.write((const char*)header, sizeof(header));
+    f.write((const char*)frames.data(), frames.size() * sizeof(ReplayFrame));
+    f.write((const char*)stepHashes.data(), stepHashes.size() * sizeof(uint64_t));
+    return f.good();
+}
+
+bool Recording::Load(const std::string& path) {
+    std::ifstream f(path, std::ios::binary);
+    uint32_t header[6];
+    if (!f.read((char*)header, sizeof(header)) || header[0] != REPLAY_MAGIC || header[1] != REPLAY_VERSION) {
+        std::cout << "ERROR::REPLAY::INVALID_FILE: " << path << std::endl;
+        return false;
+    }
+    // The counts must fit in what's left of the file, so a corrupt header can't ask for gigabytes
+    std::streamoff start = f.tellg();
+    f.seekg(0, std::ios::end);
+    uint64_t remaining = (uint64_t)(f.tellg() - start);
+    f.seekg(start);
+    if (!f || (uint64_t)header[4] * sizeof(ReplayFrame) + (uint64_t)header[5] * sizeof(uint64_t) > remaining) {
+        std::cout << "ERROR::REPLAY::INVALID_FILE: " << path << std::endl;
+        return false;
+    }
+    scene = (int)header[2];
+    seed = header[3];
+    frames.resize(header[4]);
+    stepHashes.resize(header[5]);
+    f.read((char*)frames.data(), frames.size() * sizeof(ReplayFrame));
+    f.read((char*)stepHashes.data(), stepHashes.size() * sizeof(uint64_t));
+    if (!f) {
+        std::cout << "ERROR::REPLAY::TRUNCATED_FILE: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+void Replay::StartRecording(int scene, uint32_t seed) {
+    recording = Recording();
+    recording.scene = scene;
+    recording.seed = seed;
+    mode = Mode::Recording;
+}
+
+bool Replay::StopRecording(const std::string& path) {
+    if (mode != Mode::Recording) return false;
+    mode = Mode::Off;
+    if (!recording.Save(path)) return false;
+    std::cout << "INFO::REPLAY::RECORDED " << recording.frames.size() << " frames, "
+              << recording.stepHashes.size() << " steps: " << path << std::endl;
+    return true;
+}
+
+void Replay::StartPlayback(const Recording& r) {
+    recording = r;
+    mode = Mode::Playing;
+    frameIndex = 0;
+    stepIndex = 0;
+    mismatches = 0;
+    firstMismatch = -1;
+}
+
+void Replay::StopPlayback() {
+    mode = Mode::Off;
+}
+
+void Replay::BeginFrame(GLFWwindow* window, bool& cameraActive) {
+    if (mode == Mode::Recording) {
+        current = { Time::deltaTime, cameraActive ? REPLAY_CAMERA_ACTIVE : 0u, 0.0f, 0.0f };
+        for (int i = 0; i < (int)std::size(trackedKeys); i++)
+            if (glfwGetKey(window, trackedKeys[i]) == GLFW_PRESS) current.keys |= 1u << i;
+        recording.frames.push_back(current);
+    } else if (mode == Mode::Playing) {
+        // Past the end, time stands still with no keys held
+        current = frameIndex < (int)recording.frames.size() ? recording.frames[frameIndex] : ReplayFrame{};
+        frameIndex++;
+        Time::deltaTime = current.deltaTime;
+        cameraActive = (current.keys & REPLAY_CAMERA_ACTIVE) != 0;
+    }
+}
+
+bool Replay::KeyDown(GLFWwindow* window, int key) {
+    int bit = TrackedKeyBit(key);
+    if (mode == Mode::Off || bit < 0)
+        return glfwGetKey(window, key) == GLFW_PRESS;
+    return (current.keys & (1u << bit)) != 0;
+}
+
+void Replay::FilterMouseDelta(float& dx, float& dy) {
+    if (mode == Mode::Recording) {
+        // The camera reads the mouse once per frame, after BeginFrame pushed the frame
+        recording.frames.back().mouseDeltaX = dx;
+        recording.frames.back().mouseDeltaY = dy;
+    } else if (mode == Mode::Playing) {
+        dx = current.mouseDeltaX;
+        dy = current.mouseDeltaY;
+    }
+}
+
+void Replay::Step(uint64_t stateHash) {
+    if (mode == Mode::Recording) {
+        recording.stepHashes.push_back(stateHash);
+    } else if (mode == Mode::Playing) {
+        if (stepIndex >= (int)recording.stepHashes.size() || recording.stepHashes[stepIndex] != stateHash) {
+            if (firstMismatch < 0) firstMismatch = stepIndex;
+            mismatches++;
+        }
+        stepIndex++;
+    }
+}
@@ -0,0 +1,105 @@
+#include "utils/thread_pool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+ThreadPool::ThreadPool(int threadCount) {
+    for (int i = 0; i < std::max(threadCount, 1); i++)
+        workers.emplace_back(&ThreadPool::WorkerLoop, this);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        jobs.clear();
+    }
+    jobAvailable.notify_all();
+    for (auto& worker : workers)
+        worker.join();
+}
+
+int ThreadPool::DefaultThreadCount() {
+    int hardware = (int)std::thread::hardware_concurrency();
+    return std::max(hardware - 1, 1);
+}
+
+ThreadPool& ThreadPool::Shared() {
+    static ThreadPool pool;
+    return pool;
+}
+
+void ThreadPool::Submit(std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.push_back(std::move(job));
+    }
+    jobAvailable.notify_one();
+}
+
+void ThreadPool::Wait() {
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this] { return jobs.empty() && running == 0; });
+}
+
+void ThreadPool::ParallelFor(int count, int grain, const std::function<void(int, int)>& fn) {
+    grain = std::max(grain, 1);
+    int chunks = (count + grain - 1) / grain;
+    if (chunks <= 1) {
+        if (count > 0) fn(0, count);
+        return;
+    }
+
+    // Helpers may be picked up after the last chunk is done and this call has returned,
+    // so the counters are shared-owned; fn is only touched while chunks remain
+    struct Progress {
+        std::atomic<int> next{0};
+        std::atomic<int> done{0};
+        std::mutex mutex;
+        std::condition_variable finished;
+    };
+    auto progress = std::make_shared<Progress>();
+    const std::function<void(int, int)>* body = &fn;
+
+    auto drain = [progress, body, count, grain, chunks]() {
+        int chunk;
+        while ((chunk = progress->next.fetch_add(1)) < chunks) {
+            int begin = chunk * grain;
+            (*body)(begin, std::min(begin + grain, count));
+            if (progress->done.fetch_add(1) + 1 == chunks) {
+                std::lock_guard<std::mutex> lock(progress->mutex);
+                progress->finished.notify_all();
+            }
+        }
+    };
+
+    int helpers = std::min(ThreadCount(), chunks - 1);
+    for (int i = 0; i < helpers; i++)
+        Submit(drain);
+    drain();
+
+    std::unique_lock<std::mutex> lock(progress->mutex);
+    progress->finished.wait(lock, [&] { return progress->done.load() == chunks; });
+}
+
+void ThreadPool::WorkerLoop() {
+    while (true) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            jobAvailable.wait(lock, [this] { return stopping || !jobs.empty(); });
+            if (stopping) return;
+            job = std::move(jobs.front());
+            jobs.pop_front();
+            running++;
+        }
+
+        job();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            running--;
+            if (jobs.empty() && running == 0) idle.notify_all();
+        }
+    }
+}
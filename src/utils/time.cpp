@@ -1,5 +1,6 @@
 #include "utils/time.hpp"
 
 float Time::deltaTime = 0.0f;
-float Time::time = 0.0f;
-float Time::lastFrameTime = 0.0f;
+double Time::time = 0.0;
+double Time::lastFrameTime = 0.0;
+float Time::fixedDeltaTime = 0.0f;